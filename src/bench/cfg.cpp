@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+
+// irl::Cfg construction on generated functions from a thousand to a few
+// hundred thousand blocks, the time per block should stay flat
+
+using Clock = std::chrono::steady_clock;
+
+// a run of loops, each with an if else and a nested if in its body, so
+// the graph has back edges, joins and blocks of every size
+static std::string generate(int loops)
+{
+    std::ostringstream src;
+
+    src << "int big(int n)\n{\n    int s = 0;\n    int i = 0;\n\n";
+
+    for (int l = 0; l < loops; l++)
+    {
+        src << "    i = 0;\n";
+        src << "    while (i < n)\n    {\n";
+        src << "        if (s < " << l % 97 << ")\n            s = s + i;\n        else\n            s = s - 1;\n";
+        src << "        if (i < 3)\n        {\n            if (s > n)\n                s = s / 2;\n        }\n";
+        src << "        i = i + 1;\n    }\n";
+    }
+
+    src << "\n    return s;\n}\n";
+    return src.str();
+}
+
+static std::unique_ptr<irl::IrlSegment> compile(const std::string& src)
+{
+    Lexer lexer(src);
+    auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+
+    auto ast = parse_definition(lexer);
+    ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+    ast->declare_function();
+
+    auto segment = ast->code_gen(base_context);
+    irl::renumber(*segment);
+
+    return segment;
+}
+
+static void bench(int loops, int runs)
+{
+    auto function = compile(generate(loops));
+    std::vector<double> times;
+    int blocks = 0;
+    int edges = 0;
+    size_t reachable = 0;
+
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = Clock::now();
+        irl::Cfg cfg(*function);
+        times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        blocks = cfg.size();
+        edges = 0;
+
+        for (int b = 0; b < blocks; b++)
+            edges += cfg.get_successors(b).size();
+
+        reachable = cfg.get_rpo().size();
+    }
+
+    double best = *std::min_element(times.begin(), times.end());
+
+    std::cout << blocks << " blocks (" << reachable << " reachable), " << edges << " edges, "
+        << function->instructions.size() << " instructions" << std::endl;
+    std::cout << "  " << best << " us, " << best * 1000 / blocks << " ns per block, "
+        << best * 1000 / function->instructions.size() << " ns per instruction" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+
+    for (int loops: { 125, 1250, 12500, 50000 })
+        bench(loops, runs);
+
+    return EXIT_SUCCESS;
+}
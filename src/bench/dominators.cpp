@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/constant-pool.hpp>
+#include <pseudoc/irl/dominators.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+// irl::DominatorTree (Lengauer-Tarjan) on random control flow graphs of
+// ten thousand to a million blocks, forward and backward, against the
+// iterative Cooper-Harvey-Kennedy algorithm, whose idoms it must match
+
+using Clock = std::chrono::steady_clock;
+
+// a function of n blocks where most blocks fall or jump to the next one
+// and branch somewhere near, a few reach far away, and a few return, so
+// the graph has irreducible loops and several exits
+static std::unique_ptr<irl::IrlSegment> generate(int n, irl::ConstantPool& constants)
+{
+    auto function = std::make_unique<irl::IrlSegment>();
+    std::vector<std::shared_ptr<irl::Variable>> labels(n);
+    unsigned seed = 12345;
+
+    auto next = [&]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>(seed >> 8);
+    };
+
+    for (auto& label: labels)
+    {
+        label = std::make_shared<irl::Variable>();
+        label->tp = irl::LlvmAtomic::v;
+    }
+
+    auto nearby = [&](int b)
+    {
+        int target = b + next() % 64 - 32;
+
+        if (next() % 16 == 0)
+            target = next() % n;
+
+        return std::clamp(target, 1, n - 1);
+    };
+
+    function->instructions.push_back(std::make_unique<irl::Def>("big", irl::FunctionDef { irl::LlvmAtomic::i32, {} }, std::vector<std::shared_ptr<irl::Variable>>()));
+
+    for (int b = 0; b < n; b++)
+    {
+        function->instructions.push_back(std::make_unique<irl::Label>(labels[b]));
+
+        int kind = next() % 100;
+
+        if (b == n - 1 || kind < 1)
+            function->instructions.push_back(std::make_unique<irl::Ret>(constants.get_int(irl::LlvmAtomic::i32, 0), irl::LlvmAtomic::i32));
+        else if (kind < 60)
+            function->instructions.push_back(std::make_unique<irl::JumpC>(constants.get_bool(true), labels[b + 1], labels[nearby(b)]));
+        else if (kind < 80)
+            function->instructions.push_back(std::make_unique<irl::Jump>(labels[nearby(b)]));
+        else
+            function->instructions.push_back(std::make_unique<irl::Jump>(labels[b + 1]));
+    }
+
+    function->instructions.push_back(std::make_unique<irl::EndDef>());
+    irl::renumber(*function);
+
+    return function;
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm":
+// sweeps the reverse postorder intersecting the processed predecessors
+// until no idom changes
+static std::vector<int> iterative_idoms(const irl::Cfg& cfg)
+{
+    auto& rpo = cfg.get_rpo();
+    std::vector<int> idom(cfg.size(), -1);
+
+    idom[rpo[0]] = rpo[0];
+
+    auto intersect = [&](int a, int b)
+    {
+        while (a != b)
+        {
+            while (cfg.get_rpo_index(a) > cfg.get_rpo_index(b))
+                a = idom[a];
+
+            while (cfg.get_rpo_index(b) > cfg.get_rpo_index(a))
+                b = idom[b];
+        }
+
+        return a;
+    };
+
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (size_t i = 1; i < rpo.size(); i++)
+        {
+            int b = rpo[i];
+            int new_idom = -1;
+
+            for (int p: cfg.get_predecessors(b))
+            {
+                if (idom[p] < 0)
+                    continue;
+
+                new_idom = new_idom < 0 ? p : intersect(p, new_idom);
+            }
+
+            if (idom[b] != new_idom)
+            {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    idom[rpo[0]] = -1;
+    return idom;
+}
+
+template <typename F>
+static double best_of(int runs, F f)
+{
+    std::vector<double> times;
+
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = Clock::now();
+        f();
+        times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    return *std::min_element(times.begin(), times.end());
+}
+
+static void bench(int n, int runs)
+{
+    irl::ConstantPool constants;
+    auto function = generate(n, constants);
+    irl::Cfg cfg(*function);
+
+    double forward = best_of(runs, [&]() { irl::DominatorTree tree(cfg); });
+    double backward = best_of(runs, [&]() { irl::DominatorTree tree(cfg, irl::DominatorTree::backward); });
+    double iterative = best_of(runs, [&]() { iterative_idoms(cfg); });
+
+    irl::DominatorTree tree(cfg);
+    auto idoms = iterative_idoms(cfg);
+    int mismatches = 0;
+    size_t edges = 0;
+
+    for (int b = 0; b < cfg.size(); b++)
+    {
+        mismatches += tree.get_idom(b) != idoms[b];
+        edges += cfg.get_successors(b).size();
+    }
+
+    std::cout << cfg.size() << " blocks, " << edges << " edges, " << cfg.get_rpo().size() << " reachable"
+        << (mismatches == 0 ? "" : ", " + std::to_string(mismatches) + " idoms differ") << std::endl;
+    std::cout << "  lengauer-tarjan " << forward << " ms (" << forward * 1e6 / n << " ns per block), backward "
+        << backward << " ms, iterative " << iterative << " ms (" << iterative / forward << "x)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    for (int n: { 10000, 100000, 1000000 })
+        bench(n, runs);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <pseudoc/irl/emitter.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+
+// instructions per second through irl::Emitter on big unoptimized
+// functions written to /dev/null, with the whole module in the buffer
+// against a write after every instruction
+
+using Clock = std::chrono::steady_clock;
+
+// identifiers take no digits, so values are spelled in base 26
+static std::string name(int value)
+{
+    std::string name = "t_";
+
+    do
+    {
+        name += static_cast<char>('a' + value % 26);
+        value /= 26;
+    }
+    while (value > 0);
+
+    return name;
+}
+
+// straight line arithmetic and small ifs over locals, so every kind of
+// line shows up: allocas, loads, stores, arithmetic, compares and branches
+static std::string generate(int functions, int statements)
+{
+    std::ostringstream src;
+    unsigned seed = 12345;
+
+    auto next = [&]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>(seed >> 8);
+    };
+
+    for (int f = 0; f < functions; f++)
+    {
+        src << "int f" << name(f) << "(int n)\n{\n";
+
+        for (int v = 0; v < 16; v++)
+            src << "    int " << name(v) << " = n + " << next() % 1000 << ";\n";
+
+        for (int s = 0; s < statements; s++)
+        {
+            auto target = name(next() % 16);
+            auto lhs = name(next() % 16);
+            auto rhs = name(next() % 16);
+
+            if (s % 4 == 0)
+                src << "    if (" << lhs << " < " << rhs << ")\n        " << target << " = " << lhs << " - " << rhs << ";\n";
+            else
+                src << "    " << target << " = " << lhs << " * " << next() % 100 << " + " << rhs << ";\n";
+        }
+
+        src << "    return " << name(0) << ";\n}\n\n";
+    }
+
+    return src.str();
+}
+
+static std::vector<std::unique_ptr<irl::IrlSegment>> compile(const std::string& src)
+{
+    Lexer lexer(src);
+    auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+    std::vector<std::unique_ptr<ast::Definition>> definitions;
+    std::vector<std::unique_ptr<irl::IrlSegment>> module;
+
+    while (!lexer.is_eof())
+        definitions.push_back(parse_definition(lexer));
+
+    for (auto& ast: definitions)
+    {
+        ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+        ast->declare_function();
+    }
+
+    for (auto& ast: definitions)
+    {
+        auto segment = ast->code_gen(base_context);
+        irl::renumber(*segment);
+        module.push_back(std::move(segment));
+    }
+
+    return module;
+}
+
+template <typename F>
+static double best_of(int runs, F f)
+{
+    std::vector<double> times;
+
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = Clock::now();
+        f();
+        times.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    return *std::min_element(times.begin(), times.end());
+}
+
+static void bench(int fd, int functions, int statements, int runs)
+{
+    auto module = compile(generate(functions, statements));
+    size_t instructions = 0;
+    size_t bytes = 0;
+
+    for (auto& segment: module)
+        instructions += segment->instructions.size();
+
+    irl::Emitter out(fd);
+
+    double buffered = best_of(runs, [&]()
+    {
+        for (auto& segment: module)
+        {
+            segment->emit(out);
+            out << '\n';
+        }
+
+        bytes = out.size();
+        out.flush();
+    });
+
+    double unbuffered = best_of(runs, [&]()
+    {
+        for (auto& segment: module)
+        {
+            for (auto& instruction: segment->instructions)
+            {
+                instruction->emit(out);
+                out.flush();
+            }
+
+            out << '\n';
+        }
+
+        out.flush();
+    });
+
+    std::cout << functions << " functions, " << instructions << " instructions, " << bytes / 1024 << " KiB" << std::endl;
+    std::cout << "  buffered " << instructions / buffered / 1e6 << " M instructions/s ("
+        << bytes / buffered / (1 << 20) << " MiB/s), write per instruction "
+        << instructions / unbuffered / 1e6 << " M instructions/s (" << unbuffered / buffered << "x)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    int fd = open("/dev/null", O_WRONLY);
+
+    if (fd < 0)
+    {
+        std::cout << "could not open /dev/null" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bench(fd, 1, 2000, runs);
+    bench(fd, 16, 2000, runs);
+    bench(fd, 4, 20000, runs);
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,364 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pseudoc/irl/interpreter.hpp>
+#include <pseudoc/irl/optimizer.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+
+// irl instructions per second of the bytecode interpreter against a naive
+// walk over the irl objects, which also counts the instructions executed
+
+using Clock = std::chrono::steady_clock;
+
+static const char* fib_source = R"(
+int fib(int n)
+{
+    if (n < 2)
+        return n;
+
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main()
+{
+    return fib(27);
+}
+)";
+
+// the loops of test-files/master-example.c, made to terminate and without %
+static const char* loops_source = R"(
+int conditional(int c)
+{
+    int a = 2;
+    int b = 6;
+
+    if (c > 0)
+        a = c;
+    else
+        b *= 2;
+
+    if (b > a)
+        return a;
+    else
+        return b;
+}
+
+int for_loop(int c)
+{
+    int res = 1;
+
+    for (int i = 6; i < 12; i++)
+        res *= c;
+
+    return res;
+}
+
+int while_loop(int c)
+{
+    int res = 1;
+
+    while (1)
+    {
+        if (res > 1500)
+            break;
+
+        res *= c;
+    }
+
+    return res;
+}
+
+int ass(int c)
+{
+    int v;
+    int a = 2;
+    int b = 6;
+
+    v = b * 2 + a / 4;
+    return c * v;
+}
+
+int f(int a, int b, int c)
+{
+    int d = a + b / c;
+    int e = a * b - c;
+    return d + e;
+}
+
+int main()
+{
+    int total = 0;
+
+    for (int i = 1; i < 40000; i++)
+        total += conditional(i - 20000) + for_loop(i) + while_loop(3) + ass(i) + f(i, 7, 3);
+
+    return total;
+}
+)";
+
+// interprets the irl objects as they are: values in a hash map per call,
+// labels found through another one and a virtual call per instruction
+class TreeWalker
+{
+public:
+    TreeWalker(std::vector<std::unique_ptr<irl::IrlSegment>>& module)
+    {
+        for (auto& segment: module)
+        {
+            if (segment->instructions.front()->get_opcode() != irl::Instruction::DEF)
+                continue;
+
+            auto& function = _functions[static_cast<irl::Def*>(segment->instructions.front().get())->get_id()];
+            function.segment = segment.get();
+
+            for (size_t i = 0; i < segment->instructions.size(); i++)
+            {
+                if (segment->instructions[i]->get_opcode() == irl::Instruction::LABEL)
+                    function.labels[static_cast<irl::Label*>(segment->instructions[i].get())->get_ref()->id] = i;
+            }
+        }
+    }
+
+    long call(const std::string& id, const std::vector<long>& args)
+    {
+        auto& function = _functions.at(id);
+        auto& instructions = function.segment->instructions;
+        auto def = static_cast<irl::Def*>(instructions.front().get());
+
+        std::unordered_map<int, long> values;
+
+        for (size_t i = 0; i < args.size(); i++)
+            values[def->get_params()[i]->id] = args[i];
+
+        auto eval = [&](irl::Value* value)
+        {
+            if (auto literal = dynamic_cast<irl::IntLiteral*>(value))
+                return literal->value;
+
+            return values[static_cast<irl::Variable*>(value)->id];
+        };
+
+        int previous = -1;
+        int current = -1;
+        size_t pc = 1;
+
+        auto jump = [&](irl::Variable* label)
+        {
+            pc = function.labels[label->id];
+        };
+
+        while (true)
+        {
+            auto instruction = instructions[pc++].get();
+            auto operands = instruction->get_operands();
+
+            if (instruction->get_opcode() != irl::Instruction::LABEL)
+                executed++;
+
+            switch (instruction->get_opcode())
+            {
+            case irl::Instruction::LABEL:
+                previous = current;
+                current = static_cast<irl::Label*>(instruction)->get_ref()->id;
+                break;
+
+            case irl::Instruction::ALLOCA:
+                break;
+
+            case irl::Instruction::LOAD:
+                values[instruction->get_out()->id] = eval(operands[0]->get());
+                break;
+
+            case irl::Instruction::STORE:
+                values[static_cast<irl::Variable*>(operands[1]->get())->id] = eval(operands[0]->get());
+                break;
+
+            case irl::Instruction::ADD:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) + eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::SUB:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) - eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::MUL:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) * eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::SDIV:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) / eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::ICMP:
+            {
+                long lhs = eval(operands[0]->get());
+                long rhs = eval(operands[1]->get());
+                bool res = false;
+
+                switch (static_cast<irl::ICmp*>(instruction)->get_cond())
+                {
+                case irl::ICmp::eq: res = lhs == rhs; break;
+                case irl::ICmp::ne: res = lhs != rhs; break;
+                case irl::ICmp::sgt: res = lhs > rhs; break;
+                case irl::ICmp::sge: res = lhs >= rhs; break;
+                case irl::ICmp::slt: res = lhs < rhs; break;
+                case irl::ICmp::sle: res = lhs <= rhs; break;
+                default: throw std::logic_error("unsigned compares are not benchmarked");
+                }
+
+                values[instruction->get_out()->id] = res;
+                break;
+            }
+
+            case irl::Instruction::ZEXT:
+                values[instruction->get_out()->id] = eval(operands[0]->get());
+                break;
+
+            case irl::Instruction::PHI:
+            {
+                // the phis of a block read their inputs before any is written
+                std::vector<std::pair<int, long>> incoming;
+                pc--;
+
+                while (instructions[pc]->get_opcode() == irl::Instruction::PHI)
+                {
+                    auto phi = static_cast<irl::Phi*>(instructions[pc++].get());
+
+                    for (auto& branch: phi->get_branches())
+                    {
+                        if (branch.origin->id == previous)
+                            incoming.emplace_back(phi->get_out()->id, eval(branch.val.get()));
+                    }
+                }
+
+                executed += incoming.size() - 1;
+
+                for (auto& [id, value]: incoming)
+                    values[id] = value;
+
+                break;
+            }
+
+            case irl::Instruction::CALL:
+            {
+                std::vector<long> call_args;
+
+                for (auto operand: operands)
+                    call_args.push_back(eval(operand->get()));
+
+                long res = call(static_cast<irl::Call*>(instruction)->get_id(), call_args);
+
+                if (auto out = instruction->get_out())
+                    values[out->id] = res;
+
+                break;
+            }
+
+            case irl::Instruction::RET:
+                return operands.empty() ? 0 : eval(operands[0]->get());
+
+            case irl::Instruction::JUMP:
+                jump(static_cast<irl::Jump*>(instruction)->get_target().get());
+                break;
+
+            case irl::Instruction::JUMPC:
+            {
+                auto jumpc = static_cast<irl::JumpC*>(instruction);
+                jump(eval(operands[0]->get()) ? jumpc->get_on_true().get() : jumpc->get_on_false().get());
+                break;
+            }
+
+            default:
+                throw std::logic_error("unexpected instruction");
+            }
+        }
+    }
+
+    size_t executed = 0;
+
+private:
+    struct Function
+    {
+        irl::IrlSegment* segment;
+        std::unordered_map<int, size_t> labels;
+    };
+
+    std::unordered_map<std::string, Function> _functions;
+};
+
+static std::vector<std::unique_ptr<irl::IrlSegment>> compile(const std::string& src, int opt_level)
+{
+    Lexer lexer(src);
+    auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+    std::vector<std::unique_ptr<ast::Definition>> definitions;
+
+    set_constant_folding(opt_level >= 1);
+
+    while (!lexer.is_eof())
+        definitions.push_back(parse_definition(lexer));
+
+    for (auto& ast: definitions)
+    {
+        ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+        ast->declare_function();
+    }
+
+    std::vector<std::unique_ptr<irl::IrlSegment>> module;
+    irl::Statistics stats;
+
+    for (auto& ast: definitions)
+    {
+        auto segment = ast->code_gen(base_context);
+        irl::renumber(*segment);
+        irl::optimize(*segment, *constants, opt_level, stats);
+        module.push_back(std::move(segment));
+    }
+
+    return module;
+}
+
+static double seconds(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+static void bench(const std::string& name, const std::string& src, int opt_level)
+{
+    auto module = compile(src, opt_level);
+
+    TreeWalker walker(module);
+    auto start = Clock::now();
+    long expected = walker.call("main", {});
+    double walk_time = seconds(start, Clock::now());
+
+    start = Clock::now();
+    irl::Interpreter interpreter(module);
+    auto translated = Clock::now();
+    long result = interpreter.call("main", {});
+    double run_time = seconds(translated, Clock::now());
+
+    double executed = walker.executed;
+
+    std::cout << name << " -O" << opt_level << ": " << walker.executed << " instructions, result " << result
+        << (result == expected ? "" : " (tree walk disagrees)") << std::endl;
+    std::cout << "  tree walk " << executed / walk_time / 1e6 << " M/s, bytecode " << executed / run_time / 1e6
+        << " M/s (" << walk_time / run_time << "x), translation " << seconds(start, translated) * 1e6 << " us" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int opt_level = argc > 1 && std::string(argv[1]) == "-O0" ? 0 : 1;
+
+    bench("fib", fib_source, opt_level);
+    bench("loops", loops_source, opt_level);
+
+    return EXIT_SUCCESS;
+}
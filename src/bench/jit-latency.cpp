@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/optimizer.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+#include <pseudoc/x86/jit.hpp>
+
+// time from source text to the value returned by the first call of main,
+// split in the front end (parsing, irl generation and optimization), the
+// jit (selection, allocation, encoding and mapping) and the call itself
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample
+{
+    double frontend;
+    double jit;
+    double call;
+    double total;
+};
+
+static double micros(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+static Sample run_once(const std::string& src, int opt_level, int& result)
+{
+    auto start = Clock::now();
+
+    Lexer lexer(src);
+    auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+    std::vector<std::unique_ptr<ast::Definition>> definitions;
+
+    set_constant_folding(opt_level >= 1);
+
+    while (!lexer.is_eof())
+        definitions.push_back(parse_definition(lexer));
+
+    for (auto& ast: definitions)
+    {
+        ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+        ast->declare_function();
+    }
+
+    std::vector<std::unique_ptr<irl::IrlSegment>> module;
+    irl::Statistics stats;
+
+    for (auto& ast: definitions)
+    {
+        auto segment = ast->code_gen(base_context);
+        irl::renumber(*segment);
+        irl::optimize(*segment, *constants, opt_level, stats);
+        module.push_back(std::move(segment));
+    }
+
+    auto generated = Clock::now();
+
+    x86::Jit jit(ftable, opt_level);
+    jit.add(module);
+    auto entry = jit.get_function<int()>("main");
+
+    auto compiled = Clock::now();
+
+    result = entry ? entry() : -1;
+
+    auto called = Clock::now();
+
+    return { micros(start, generated), micros(generated, compiled), micros(compiled, called), micros(start, called) };
+}
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage:" << std::endl << "jit-latency <source-file> [-O0|-O1|-O2] [iterations]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream ifs(argv[1]);
+
+    if (!ifs.is_open())
+    {
+        std::cout << "could not open source file\"" << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string src((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
+    int opt_level = 0;
+
+    if (argc > 2 && (std::string(argv[2]) == "-O1" || std::string(argv[2]) == "-O2"))
+        opt_level = argv[2][2] - '0';
+
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 100;
+
+    std::vector<double> frontend, jit, call, total;
+    int result = 0;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        auto sample = run_once(src, opt_level, result);
+
+        frontend.push_back(sample.frontend);
+        jit.push_back(sample.jit);
+        call.push_back(sample.call);
+        total.push_back(sample.total);
+    }
+
+    std::cout << "main returned " << result << " (" << iterations << " runs, -O" << opt_level << ")" << std::endl;
+    std::cout << "median us: frontend " << median(frontend) << ", jit " << median(jit) << ", first call " << median(call)
+        << ", total " << median(total) << std::endl;
+    std::cout << "min us: total " << *std::min_element(total.begin(), total.end()) << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/interpreter.hpp>
+#include <pseudoc/irl/layout.hpp>
+#include <pseudoc/irl/optimizer.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+#include <pseudoc/x86/jit.hpp>
+
+// loop heavy code with its blocks in codegen order against the same code
+// after irl::layout, run natively through the jit and by the interpreter
+
+using Clock = std::chrono::steady_clock;
+
+static const char* loops_source = R"(
+int nested(int n)
+{
+    int s = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            if (i < j)
+                s = s + i * j;
+            else
+                s = s - j;
+        }
+    }
+
+    return s;
+}
+
+int collatz(int n)
+{
+    int steps = 0;
+
+    while (n != 1)
+    {
+        int half = n / 2;
+
+        if (half * 2 == n)
+            n = half;
+        else
+            n = 3 * n + 1;
+
+        steps++;
+    }
+
+    return steps;
+}
+
+int main()
+{
+    int s = nested(600);
+
+    for (int k = 1; k < 30000; k++)
+        s = s + collatz(k);
+
+    return s;
+}
+)";
+
+struct Compiled
+{
+    std::shared_ptr<FunctionTable> ftable;
+    std::vector<std::unique_ptr<irl::IrlSegment>> module;
+};
+
+static Compiled compile(const std::string& src, bool place_blocks)
+{
+    Lexer lexer(src);
+    Compiled compiled { std::make_shared<FunctionTable>(), {} };
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+    std::vector<std::unique_ptr<ast::Definition>> definitions;
+    irl::Statistics stats;
+
+    set_constant_folding(true);
+
+    while (!lexer.is_eof())
+        definitions.push_back(parse_definition(lexer));
+
+    for (auto& ast: definitions)
+    {
+        ast->set_variable_scope(std::make_shared<VariableScope>(constants), compiled.ftable);
+        ast->declare_function();
+    }
+
+    for (auto& ast: definitions)
+    {
+        auto segment = ast->code_gen(base_context);
+        irl::renumber(*segment);
+        irl::optimize(*segment, *constants, 1, stats);
+
+        if (place_blocks)
+        {
+            irl::layout(*segment);
+            irl::renumber(*segment);
+        }
+
+        compiled.module.push_back(std::move(segment));
+    }
+
+    return compiled;
+}
+
+template <typename F>
+static double best_of(int runs, F f)
+{
+    std::vector<double> times;
+
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = Clock::now();
+        f();
+        times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    return *std::min_element(times.begin(), times.end());
+}
+
+int main(int argc, char **argv)
+{
+    int runs = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    double native[2];
+    double interpreted[2];
+    int results[2][2];
+
+    for (int placed = 0; placed < 2; placed++)
+    {
+        auto compiled = compile(loops_source, placed);
+
+        x86::Jit jit(compiled.ftable);
+        jit.add(compiled.module);
+        auto entry = jit.get_function<int()>("main");
+
+        native[placed] = best_of(runs, [&]() { results[placed][0] = entry(); });
+
+        irl::Interpreter interpreter(compiled.module);
+        interpreted[placed] = best_of(runs, [&]() { results[placed][1] = interpreter.call("main", {}); });
+    }
+
+    bool agree = results[0][0] == results[1][0] && results[0][1] == results[1][1] && results[0][0] == results[0][1];
+
+    std::cout << "main returned " << results[1][0] << (agree ? "" : " (the runs disagree)") << std::endl;
+    std::cout << "  native: codegen order " << native[0] << " ms, laid out " << native[1] << " ms ("
+        << native[0] / native[1] << "x)" << std::endl;
+    std::cout << "  interpreter: codegen order " << interpreted[0] << " ms, laid out " << interpreted[1] << " ms ("
+        << interpreted[0] / interpreted[1] << "x)" << std::endl;
+
+    return EXIT_SUCCESS;
+}
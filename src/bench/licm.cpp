@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/dce.hpp>
+#include <pseudoc/irl/gvn.hpp>
+#include <pseudoc/irl/licm.hpp>
+#include <pseudoc/irl/mem2reg.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/irl/sccp.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+
+// instructions executed by nested loop kernels through the -O1 passes,
+// with and without loop invariant code motion, counted by a walk over the
+// irl of the function, and the time licm itself takes
+
+using Clock = std::chrono::steady_clock;
+
+struct Kernel
+{
+    const char* source;
+    std::vector<long> args;
+};
+
+static const Kernel kernels[] = {
+    // test-files/invariant.c, with a square that only depends on the parameters
+    { R"(
+int grid(int n, int m, int scale)
+{
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < m; j++)
+        {
+            int base = scale * scale + n * m;
+            int row = i * scale;
+
+            total = total + base + row + j;
+        }
+    }
+
+    return total;
+}
+)", { 300, 300, 7 } },
+
+    // an index per level, each invariant in the loops below it
+    { R"(
+int cube(int n, int w, int h)
+{
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            for (int k = 0; k < n; k++)
+                total = total + (i * w + j) * h + k * (w + h) + w * h / 3;
+        }
+    }
+
+    return total;
+}
+)", { 60, 13, 17 } },
+
+    // everything in the loops depends on them, nothing to hoist
+    { R"(
+int collatz(int limit)
+{
+    int total = 0;
+
+    for (int k = 1; k < limit; k++)
+    {
+        int x = k;
+
+        while (x > 1)
+        {
+            if (x / 2 * 2 == x)
+                x = x / 2;
+            else
+                x = 3 * x + 1;
+
+            total = total + 1;
+        }
+    }
+
+    return total;
+}
+)", { 10000 } },
+};
+
+// runs the function on its irl objects, block by block, and counts the
+// instructions executed: labels are left out and phis count one per copy
+static long run(irl::IrlSegment& function, irl::Cfg& cfg, const std::vector<long>& args, size_t& executed)
+{
+    auto& instructions = function.instructions;
+    auto def = static_cast<irl::Def*>(instructions.front().get());
+    std::vector<long> values(irl::id_bound(function));
+    std::vector<std::pair<int, long>> incoming;
+
+    for (size_t i = 0; i < args.size(); i++)
+        values[def->get_params()[i]->id] = args[i];
+
+    auto eval = [&](irl::Value* value)
+    {
+        if (auto literal = dynamic_cast<irl::IntLiteral*>(value))
+            return literal->value;
+
+        return values[static_cast<irl::Variable*>(value)->id];
+    };
+
+    int previous = -1;
+    int b = 0;
+
+    while (true)
+    {
+        auto& block = cfg.get_block(b);
+        size_t i = block.begin + 1;
+        int next = -1;
+
+        // the phis of a block read their inputs before any is written
+        incoming.clear();
+
+        for (; i < block.end && instructions[i]->get_opcode() == irl::Instruction::PHI; i++)
+        {
+            auto phi = static_cast<irl::Phi*>(instructions[i].get());
+
+            for (auto& branch: phi->get_branches())
+            {
+                if (previous >= 0 && branch.origin->id == cfg.get_block(previous).label->id)
+                    incoming.emplace_back(phi->get_out()->id, eval(branch.val.get()));
+            }
+        }
+
+        executed += incoming.size();
+
+        for (auto& [id, value]: incoming)
+            values[id] = value;
+
+        for (; i < block.end; i++)
+        {
+            auto instruction = instructions[i].get();
+            auto operands = instruction->get_operands();
+
+            executed++;
+
+            switch (instruction->get_opcode())
+            {
+            case irl::Instruction::ALLOCA:
+                break;
+
+            case irl::Instruction::LOAD:
+                values[instruction->get_out()->id] = eval(operands[0]->get());
+                break;
+
+            case irl::Instruction::STORE:
+                values[static_cast<irl::Variable*>(operands[1]->get())->id] = eval(operands[0]->get());
+                break;
+
+            case irl::Instruction::ADD:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) + eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::SUB:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) - eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::MUL:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) * eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::SDIV:
+                values[instruction->get_out()->id] = static_cast<int32_t>(eval(operands[0]->get()) / eval(operands[1]->get()));
+                break;
+
+            case irl::Instruction::ICMP:
+            {
+                long lhs = eval(operands[0]->get());
+                long rhs = eval(operands[1]->get());
+                bool res = false;
+
+                switch (static_cast<irl::ICmp*>(instruction)->get_cond())
+                {
+                case irl::ICmp::eq: res = lhs == rhs; break;
+                case irl::ICmp::ne: res = lhs != rhs; break;
+                case irl::ICmp::sgt: res = lhs > rhs; break;
+                case irl::ICmp::sge: res = lhs >= rhs; break;
+                case irl::ICmp::slt: res = lhs < rhs; break;
+                case irl::ICmp::sle: res = lhs <= rhs; break;
+                default: throw std::logic_error("unsigned compares are not benchmarked");
+                }
+
+                values[instruction->get_out()->id] = res;
+                break;
+            }
+
+            case irl::Instruction::ZEXT:
+                values[instruction->get_out()->id] = eval(operands[0]->get());
+                break;
+
+            case irl::Instruction::RET:
+                return operands.empty() ? 0 : eval(operands[0]->get());
+
+            case irl::Instruction::JUMP:
+                next = cfg.get_block_of(*static_cast<irl::Jump*>(instruction)->get_target());
+                break;
+
+            case irl::Instruction::JUMPC:
+            {
+                auto jumpc = static_cast<irl::JumpC*>(instruction);
+                next = cfg.get_block_of(eval(operands[0]->get()) ? *jumpc->get_on_true() : *jumpc->get_on_false());
+                break;
+            }
+
+            default:
+                throw std::logic_error("unexpected instruction");
+            }
+        }
+
+        previous = b;
+        b = next;
+    }
+}
+
+// mem2reg, sccp and gvn, then licm or not, then dce, as -O1 orders them
+static std::unique_ptr<irl::IrlSegment> compile(const std::string& src, bool hoist, int& hoisted, double& licm_time)
+{
+    Lexer lexer(src);
+    auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+
+    set_constant_folding(true);
+
+    auto ast = parse_definition(lexer);
+    ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+    ast->declare_function();
+
+    auto function = ast->code_gen(base_context);
+    irl::renumber(*function);
+
+    irl::mem2reg(*function, *constants);
+    irl::renumber(*function);
+    irl::sccp(*function, *constants);
+    irl::renumber(*function);
+    irl::gvn(*function);
+    irl::renumber(*function);
+
+    if (hoist)
+    {
+        auto start = Clock::now();
+        hoisted = irl::licm(*function);
+        licm_time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        irl::renumber(*function);
+    }
+
+    irl::dce(*function);
+    irl::renumber(*function);
+
+    return function;
+}
+
+struct Result
+{
+    long value;
+    size_t executed;
+    double time;
+};
+
+static Result measure(irl::IrlSegment& function, const std::vector<long>& args, int runs)
+{
+    irl::Cfg cfg(function);
+    Result result { 0, 0, 1e30 };
+
+    for (int i = 0; i < runs; i++)
+    {
+        size_t executed = 0;
+        auto start = Clock::now();
+
+        result.value = run(function, cfg, args, executed);
+        result.time = std::min(result.time, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        result.executed = executed;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    for (auto& kernel: kernels)
+    {
+        int hoisted = 0;
+        double licm_time = 0;
+
+        auto plain = compile(kernel.source, false, hoisted, licm_time);
+        auto hoisting = compile(kernel.source, true, hoisted, licm_time);
+
+        auto before = measure(*plain, kernel.args, runs);
+        auto after = measure(*hoisting, kernel.args, runs);
+        auto& name = static_cast<irl::Def*>(plain->instructions.front().get())->get_id();
+
+        std::cout << name << ": " << hoisted << " hoisted in " << licm_time << " us"
+            << (before.value == after.value ? "" : ", results differ") << std::endl;
+        std::cout << "  without licm " << before.executed << " instructions (" << before.time << " ms), with "
+            << after.executed << " (" << after.time << " ms), " << double(before.executed) / after.executed
+            << "x fewer" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
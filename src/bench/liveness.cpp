@@ -0,0 +1,230 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/liveness.hpp>
+#include <pseudoc/irl/optimizer.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/lexer.hpp>
+#include <pseudoc/parser.hpp>
+
+// irl liveness with packed bit sets and the postorder worklist against a
+// naive round robin over std::vector<bool>, on generated functions with
+// thousands of temporaries live across a loop of many blocks
+
+using Clock = std::chrono::steady_clock;
+
+// identifiers take no digits, so values are spelled in base 26
+static std::string name(int value)
+{
+    std::string name = "t_";
+
+    do
+    {
+        name += static_cast<char>('a' + value % 26);
+        value /= 26;
+    }
+    while (value > 0);
+
+    return name;
+}
+
+// values chained off the parameter, so nothing folds, then a loop whose
+// body reads them from many small blocks
+static std::string generate(int values, int blocks)
+{
+    std::ostringstream src;
+    unsigned seed = 12345;
+
+    auto next = [&]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>(seed >> 8);
+    };
+
+    src << "int big(int n)\n{\n";
+    src << "    int " << name(0) << " = n;\n";
+
+    for (int v = 1; v < values; v++)
+        src << "    int " << name(v) << " = " << name(next() % v) << " * 3 + " << name(v - 1) << ";\n";
+
+    src << "    int s = 0;\n    int i = 0;\n\n    while (i < n)\n    {\n";
+
+    for (int b = 0; b < blocks; b++)
+    {
+        src << "        if (i < " << next() % 100 << ")\n";
+        src << "            s = s + " << name(next() % values) << " - " << name(next() % values) << ";\n";
+    }
+
+    src << "        i = i + 1;\n    }\n\n    return s";
+
+    for (int b = 0; b < 8; b++)
+        src << " + " << name(next() % values);
+
+    src << ";\n}\n";
+    return src.str();
+}
+
+static std::unique_ptr<irl::IrlSegment> compile(const std::string& src)
+{
+    Lexer lexer(src);
+    auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
+
+    irl::Context base_context;
+    irl::Statistics stats;
+
+    set_constant_folding(true);
+
+    auto ast = parse_definition(lexer);
+    ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+    ast->declare_function();
+
+    auto segment = ast->code_gen(base_context);
+    irl::renumber(*segment);
+    irl::optimize(*segment, *constants, 1, stats);
+
+    return segment;
+}
+
+// the textbook formulation, every block every round (backward, as the
+// problem flows) until nothing changes
+struct NaiveLiveness
+{
+    std::vector<std::vector<bool>> live_in;
+    std::vector<std::vector<bool>> live_out;
+
+    NaiveLiveness(irl::IrlSegment& function, irl::Cfg& cfg)
+    {
+        int bound = irl::id_bound(function);
+        std::vector<std::vector<bool>> gen(cfg.size(), std::vector<bool>(bound));
+        std::vector<std::vector<bool>> kill(cfg.size(), std::vector<bool>(bound));
+        std::vector<std::vector<bool>> phi_uses(cfg.size(), std::vector<bool>(bound));
+
+        live_in.assign(cfg.size(), std::vector<bool>(bound));
+        live_out.assign(cfg.size(), std::vector<bool>(bound));
+
+        for (int b = 0; b < cfg.size(); b++)
+        {
+            if (!cfg.is_reachable(b))
+                continue;
+
+            auto& block = cfg.get_block(b);
+
+            for (size_t i = block.begin; i < block.end; i++)
+            {
+                auto& instruction = *function.instructions[i];
+
+                if (instruction.get_opcode() == irl::Instruction::PHI)
+                {
+                    for (auto& branch: static_cast<irl::Phi&>(instruction).get_branches())
+                    {
+                        if (auto var = dynamic_cast<irl::Variable*>(branch.val.get()))
+                            phi_uses[cfg.get_block_of(*branch.origin)][var->id] = true;
+                    }
+                }
+                else
+                {
+                    for (auto operand: instruction.get_operands())
+                    {
+                        auto var = dynamic_cast<irl::Variable*>(operand->get());
+
+                        if (var && !kill[b][var->id])
+                            gen[b][var->id] = true;
+                    }
+                }
+
+                if (auto out = instruction.get_out())
+                    kill[b][out->id] = true;
+            }
+        }
+
+        bool changed = true;
+
+        while (changed)
+        {
+            changed = false;
+
+            for (int b = cfg.size() - 1; b >= 0; b--)
+            {
+                if (!cfg.is_reachable(b))
+                    continue;
+
+                std::vector<bool> out = phi_uses[b];
+
+                for (int succ: cfg.get_successors(b))
+                {
+                    for (int v = 0; v < bound; v++)
+                        out[v] = out[v] || live_in[succ][v];
+                }
+
+                std::vector<bool> in(bound);
+
+                for (int v = 0; v < bound; v++)
+                    in[v] = gen[b][v] || (out[v] && !kill[b][v]);
+
+                changed = changed || in != live_in[b];
+                live_in[b] = std::move(in);
+                live_out[b] = std::move(out);
+            }
+        }
+    }
+};
+
+static double micros(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+static void bench(int values, int blocks, int iterations)
+{
+    auto function = compile(generate(values, blocks));
+    irl::Cfg cfg(*function);
+
+    auto start = Clock::now();
+
+    for (int i = 0; i < iterations; i++)
+        irl::Liveness liveness(*function, cfg);
+
+    auto packed = Clock::now();
+
+    for (int i = 0; i < iterations; i++)
+        NaiveLiveness naive(*function, cfg);
+
+    auto finished = Clock::now();
+
+    irl::Liveness liveness(*function, cfg);
+    NaiveLiveness naive(*function, cfg);
+    bool agree = true;
+    size_t live = 0;
+
+    for (int b = 0; b < cfg.size(); b++)
+    {
+        for (int v = 0; v < liveness.get_live_in(b).size(); v++)
+            agree = agree && liveness.get_live_in(b).test(v) == naive.live_in[b][v] && liveness.get_live_out(b).test(v) == naive.live_out[b][v];
+
+        live += liveness.get_live_in(b).count();
+    }
+
+    double packed_time = micros(start, packed) / iterations;
+    double naive_time = micros(packed, finished) / iterations;
+
+    std::cout << irl::id_bound(*function) << " ids, " << cfg.size() << " blocks, " << live << " live-in bits, "
+        << liveness.get_visits() << " visits" << (agree ? "" : " (naive disagrees)") << std::endl;
+    std::cout << "  bit sets " << packed_time << " us, naive " << naive_time << " us (" << naive_time / packed_time << "x)"
+        << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+
+    bench(1000, 50, iterations);
+    bench(4000, 200, iterations);
+    bench(8000, 400, iterations);
+
+    return EXIT_SUCCESS;
+}
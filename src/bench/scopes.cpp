@@ -0,0 +1,102 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pseudoc/variable-map.hpp>
+
+// variable lookups from the bottom of deeply nested blocks, on the flat
+// shadow stack VariableScope against parent chained maps, the scheme it
+// replaced
+
+using Clock = std::chrono::steady_clock;
+
+// one map per block, a lookup hashes the name again at every level it climbs
+class ChainedScope
+{
+public:
+    ChainedScope(ChainedScope* parent):
+        _parent(parent)
+    {
+    }
+
+    void add_variable(const std::string& id, std::shared_ptr<irl::Variable> var)
+    {
+        _variables[id] = std::move(var);
+    }
+
+    std::shared_ptr<irl::Variable> get_variable(const std::string& id)
+    {
+        auto it = _variables.find(id);
+
+        if (it != _variables.end())
+            return it->second;
+
+        if (_parent)
+            return _parent->get_variable(id);
+
+        throw std::logic_error("reference to undeclared variable " + id);
+    }
+
+private:
+    ChainedScope* _parent;
+    std::unordered_map<std::string, std::shared_ptr<irl::Variable>> _variables;
+};
+
+static double nanos(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::nano>(to - from).count();
+}
+
+// a variable per block, then lookups of every depth's variable from the innermost
+static void bench_tables(int depth, int lookups)
+{
+    auto constants = std::make_shared<irl::ConstantPool>();
+    VariableScope flat(constants);
+    std::vector<std::unique_ptr<ChainedScope>> chain;
+    std::vector<std::string> names;
+    std::vector<int> symbols;
+
+    for (int d = 0; d < depth; d++)
+    {
+        names.push_back("v" + std::to_string(d));
+        symbols.push_back(flat.intern(names.back()));
+
+        flat.push_block();
+        auto var = flat.add_variable(symbols.back(), irl::LlvmAtomic::i32);
+
+        chain.push_back(std::make_unique<ChainedScope>(d > 0 ? chain.back().get() : nullptr));
+        chain.back()->add_variable(names.back(), std::move(var));
+    }
+
+    size_t found = 0;
+    auto start = Clock::now();
+
+    for (int i = 0; i < lookups; i++)
+        found += flat.get_variable(symbols[i % depth]) != nullptr;
+
+    auto flat_done = Clock::now();
+
+    for (int i = 0; i < lookups; i++)
+        found += chain.back()->get_variable(names[i % depth]) != nullptr;
+
+    auto finished = Clock::now();
+
+    double flat_time = nanos(start, flat_done) / lookups;
+    double chained_time = nanos(flat_done, finished) / lookups;
+
+    std::cout << "depth " << depth << (found == 2 * size_t(lookups) ? "" : " (lookups failed)") << std::endl;
+    std::cout << "  flat " << flat_time << " ns, chained " << chained_time << " ns per lookup ("
+        << chained_time / flat_time << "x)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int lookups = argc > 1 ? std::stoi(argv[1]) : 2000000;
+
+    for (int depth: { 1, 16, 64, 256, 1024 })
+        bench_tables(depth, lookups);
+
+    return EXIT_SUCCESS;
+}
@@ -25,6 +25,11 @@ namespace ast
             _ftable = std::move(ftable);
         }
 
+        // folds the constant expressions below the node in place
+        virtual void fold_constants()
+        {
+        }
+
         irl::LlvmAtomic get_type()
         {
             return _tp;
@@ -33,6 +38,6 @@ namespace ast
     protected:
         std::shared_ptr<VariableScope> _var_scope;
         std::shared_ptr<FunctionTable> _ftable;
-        irl::LlvmAtomic _tp;
+        irl::LlvmAtomic _tp = irl::LlvmAtomic::error;
     };
 }
\ No newline at end of file
@@ -10,26 +10,76 @@ FunctionParam::FunctionParam(std::string identifier, irl::LlvmAtomic tp):
 
 std::string FunctionParam::print()
 {
-    return irl::atomic_to_string(_tp) + " " + _identifier;
+    return std::string(irl::atomic_to_string(_tp)) + " " + _identifier;
 }
 
 std::unique_ptr<irl::IrlSegment> FunctionParam::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    auto ref = _var_scope->add_variable(_identifier, _tp);
+    auto ref = _var_scope->add_variable(_symbol, _tp);
 
-    segment->instructions.push_back(std::make_unique<irl::Alloca>(ref, 4));
-    segment->instructions.push_back(std::make_unique<irl::Store>(_param_ref, ref, 4));
+    segment->instructions.push_back(std::make_unique<irl::Alloca>(ref, irl::atomic_alignment(_tp)));
+    segment->instructions.push_back(std::make_unique<irl::Store>(_param_ref, ref, irl::atomic_alignment(_tp)));
 
     segment->out_value = std::move(ref);
 
     return segment;
 }
 
-void FunctionParam::add_temp()
+std::shared_ptr<irl::Variable> FunctionParam::add_temp()
 {
     _param_ref = _var_scope->new_temp(_tp);
+    return _param_ref;
+}
+
+FunctionDeclaration::FunctionDeclaration(std::string identifier, irl::LlvmAtomic tp, std::unique_ptr<std::vector<std::unique_ptr<FunctionParam>>> params):
+    _identifier(std::move(identifier)),
+    _params(std::move(*params))
+{
+    _tp = tp;
+}
+
+std::string FunctionDeclaration::print()
+{
+    std::string params = "(";
+    std::string junc = "";
+
+    for (auto& p: _params)
+    {
+        params += junc + p->print();
+        junc = ", ";
+    }
+
+    params += ");\n";
+
+    return std::string(irl::atomic_to_string(_tp))
+        + " " + _identifier + params;
+}
+
+void FunctionDeclaration::declare_function()
+{
+    irl::FunctionDef def;
+    def.tp = _tp;
+
+    for (auto& p: _params)
+    {
+        def.params.push_back(p->get_type());
+    }
+
+    _first = _ftable->declare_function(_identifier, def);
+}
+
+std::unique_ptr<irl::IrlSegment> FunctionDeclaration::code_gen(irl::Context context)
+{
+    auto segment = std::make_unique<irl::IrlSegment>();
+
+    // functions defined in this module are emitted by their definition,
+    // and a repeated prototype was already declared by the first one
+    if (_first && !_ftable->is_defined(_identifier))
+        segment->instructions.push_back(std::make_unique<irl::Declare>(_identifier, _ftable->get_function(_identifier)));
+
+    return segment;
 }
 
 FunctionDefinition::FunctionDefinition(std::string identifier, irl::LlvmAtomic tp, std::unique_ptr<std::vector<std::unique_ptr<FunctionParam>>> params, std::unique_ptr<CompoundStatement> body):
@@ -53,29 +103,41 @@ std::string FunctionDefinition::print()
 
     params += ")\n";
 
-    return irl::atomic_to_string(_tp)
+    return std::string(irl::atomic_to_string(_tp))
         + " " + _identifier + params
         + _body->print() + "\n";
 }
 
-std::unique_ptr<irl::IrlSegment> FunctionDefinition::code_gen(irl::Context context)
+void FunctionDefinition::declare_function()
 {
-    auto segment = std::make_unique<irl::IrlSegment>();
-
     irl::FunctionDef def;
     def.tp = _tp;
 
-    for(auto& p: _params)
+    for (auto& p: _params)
     {
-        p->add_temp();
         def.params.push_back(p->get_type());
     }
 
-    _ftable->add_function(_identifier, def);
+    _ftable->declare_function(_identifier, def);
+    _ftable->define_function(_identifier);
+}
+
+std::unique_ptr<irl::IrlSegment> FunctionDefinition::code_gen(irl::Context context)
+{
+    auto segment = std::make_unique<irl::IrlSegment>();
+    auto def = _ftable->get_function(_identifier);
+
+    std::vector<std::shared_ptr<irl::Variable>> param_refs;
+
+    for(auto& p: _params)
+    {
+        param_refs.push_back(p->add_temp());
+    }
 
-    segment->instructions.push_back(std::make_unique<irl::Def>(_identifier, def));
+    segment->instructions.push_back(std::make_unique<irl::Def>(_identifier, def, std::move(param_refs)));
 
-    _var_scope->skip();
+    // the entry block, so phis can name it as an origin
+    segment->instructions.push_back(std::make_unique<irl::Label>(_var_scope->new_temp(irl::LlvmAtomic::v)));
 
     for(auto& p: _params)
     {
@@ -98,6 +160,18 @@ std::unique_ptr<irl::IrlSegment> FunctionDefinition::code_gen(irl::Context conte
         segment->instructions.push_back(std::move(i));
     }
 
+    // falling off the end returns, so every block ends in a terminator
+    if (!segment->instructions.back()->is_terminator())
+    {
+        auto res = _tp == irl::LlvmAtomic::v ? nullptr : _var_scope->get_constants()->get_int(_tp, 0);
+        segment->instructions.push_back(std::make_unique<irl::Ret>(std::move(res), _tp));
+    }
+
     segment->instructions.push_back(std::make_unique<irl::EndDef>());
     return segment;
 }
+
+void FunctionDefinition::fold_constants()
+{
+    _body->fold_constants();
+}
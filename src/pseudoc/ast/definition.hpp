@@ -13,6 +13,12 @@ namespace ast
         virtual std::string print() override = 0;
         virtual std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override = 0;
 
+        // first compilation phase: registers the signature on the function
+        // table, so every body can call any function of the module
+        virtual void declare_function()
+        {
+        }
+
         // virtual void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         // {
         //     _var_scope = std::make_shared<VariableScope>();
@@ -28,13 +34,38 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
-        void add_temp();
+        void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
+        {
+            _symbol = var_scope->intern(_identifier);
+
+            _var_scope = std::move(var_scope);
+            _ftable = std::move(ftable);
+        }
+
+        std::shared_ptr<irl::Variable> add_temp();
 
     private:
         std::string _identifier;
+        int _symbol;
         std::shared_ptr<irl::Variable> _param_ref;
     };
 
+    class FunctionDeclaration : public Definition
+    {
+    public:
+        FunctionDeclaration(std::string identifier, irl::LlvmAtomic tp, std::unique_ptr<std::vector<std::unique_ptr<FunctionParam>>> params);
+
+        std::string print() override;
+        std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        void declare_function() override;
+
+    private:
+        std::string _identifier;
+        std::vector<std::unique_ptr<FunctionParam>> _params;
+        bool _first = false;
+    };
+
     class FunctionDefinition : public Definition
     {
     public:
@@ -43,6 +74,10 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
+        void declare_function() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
             _body->forward_variable_scope(var_scope, ftable);
@@ -52,7 +87,7 @@ namespace ast
                 p->set_variable_scope(var_scope, ftable);
             }
 
-            _var_scope = std::make_shared<VariableScope>(std::move(var_scope));
+            _var_scope = std::move(var_scope);
             _ftable = std::move(ftable);
         }
 
@@ -1,12 +1,28 @@
 #include <pseudoc/ast/expression.hpp>
 
+#include <cstdint>
 #include <iostream>
 
 using namespace ast;
 
+void ast::fold_expression(std::unique_ptr<Expression>& expr)
+{
+    expr->fold_constants();
+
+    if (auto folded = expr->fold())
+        expr = std::move(folded);
+}
+
+// i32 arithmetic wraps around, as the generated code does
+static int wrap(int64_t value)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
 I32Constant::I32Constant(int value)
 {
     _value = value;
+    _tp = irl::LlvmAtomic::i32;
 }
 
 std::string I32Constant::print()
@@ -17,12 +33,26 @@ std::string I32Constant::print()
 std::unique_ptr<irl::IrlSegment> I32Constant::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
-    auto literal = std::make_unique<irl::IntLiteral>();
+    segment->out_value = _var_scope->get_constants()->get_int(irl::LlvmAtomic::i32, _value);
+
+    return segment;
+}
+
+BoolConstant::BoolConstant(bool value)
+{
+    _value = value;
+    _tp = irl::LlvmAtomic::b;
+}
 
-    literal->tp = irl::LlvmAtomic::i32;
-    literal->value = _value;
+std::string BoolConstant::print()
+{
+    return _value ? "true" : "false";
+}
 
-    segment->out_value = std::move(literal);
+std::unique_ptr<irl::IrlSegment> BoolConstant::code_gen(irl::Context context)
+{
+    auto segment = std::make_unique<irl::IrlSegment>();
+    segment->out_value = _var_scope->get_constants()->get_bool(_value);
 
     return segment;
 }
@@ -30,6 +60,7 @@ std::unique_ptr<irl::IrlSegment> I32Constant::code_gen(irl::Context context)
 F32Constant::F32Constant(float value)
 {
     _value = value;
+    _tp = irl::LlvmAtomic::fp;
 }
 
 std::string F32Constant::print()
@@ -39,8 +70,10 @@ std::string F32Constant::print()
 
 std::unique_ptr<irl::IrlSegment> F32Constant::code_gen(irl::Context context)
 {
-    // TODO
-    return std::make_unique<irl::IrlSegment>();
+    auto segment = std::make_unique<irl::IrlSegment>();
+    segment->out_value = _var_scope->get_constants()->get_float(_value);
+
+    return segment;
 }
 
 VariableRef::VariableRef(std::string identifier)
@@ -57,10 +90,10 @@ std::unique_ptr<irl::IrlSegment> VariableRef::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    auto ref = _var_scope->get_variable(_identifier);
+    auto ref = _var_scope->get_variable(_symbol);
     auto out = _var_scope->new_temp(ref->tp);
 
-    segment->instructions.push_back(std::make_unique<irl::Load>(ref, out, 4));
+    segment->instructions.push_back(std::make_unique<irl::Load>(ref, out, irl::atomic_alignment(ref->tp)));
     segment->out_value = std::move(out);
 
     return segment;
@@ -81,19 +114,15 @@ std::unique_ptr<irl::IrlSegment> PreIncrement::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    auto ref = _var_scope->get_variable(_identifier);
+    auto ref = _var_scope->get_variable(_symbol);
     auto tp = ref->tp;
     auto ld_out = _var_scope->new_temp(tp);
     auto out = _var_scope->new_temp(tp);
+    auto literal = _var_scope->get_constants()->get_int(tp, _value);
 
-    auto literal = std::make_unique<irl::IntLiteral>();
-
-    literal->tp = tp;
-    literal->value = _value;
-
-    segment->instructions.push_back(std::make_unique<irl::Load>(ref, ld_out, 4));
+    segment->instructions.push_back(std::make_unique<irl::Load>(ref, ld_out, irl::atomic_alignment(tp)));
     segment->instructions.push_back(std::make_unique<irl::Add>(out, ld_out, std::move(literal), tp));
-    segment->instructions.push_back(std::make_unique<irl::Store>(out, std::move(ref), 4));
+    segment->instructions.push_back(std::make_unique<irl::Store>(out, std::move(ref), irl::atomic_alignment(tp)));
     segment->out_value = std::move(out);
 
     return segment;
@@ -114,19 +143,15 @@ std::unique_ptr<irl::IrlSegment> PostIncrement::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    auto ref = _var_scope->get_variable(_identifier);
+    auto ref = _var_scope->get_variable(_symbol);
     auto tp = ref->tp;
     auto out = _var_scope->new_temp(tp);
     auto inc_out = _var_scope->new_temp(tp);
+    auto literal = _var_scope->get_constants()->get_int(tp, _value);
 
-    auto literal = std::make_unique<irl::IntLiteral>();
-
-    literal->tp = tp;
-    literal->value = _value;
-
-    segment->instructions.push_back(std::make_unique<irl::Load>(ref, out, 4));
+    segment->instructions.push_back(std::make_unique<irl::Load>(ref, out, irl::atomic_alignment(ref->tp)));
     segment->instructions.push_back(std::make_unique<irl::Add>(inc_out, out, std::move(literal), tp));
-    segment->instructions.push_back(std::make_unique<irl::Store>(std::move(inc_out), std::move(ref), 4));
+    segment->instructions.push_back(std::make_unique<irl::Store>(std::move(inc_out), std::move(ref), irl::atomic_alignment(tp)));
     segment->out_value = std::move(out);
 
     return segment;
@@ -138,6 +163,18 @@ BinaryOp::BinaryOp(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression>
 {
 }
 
+void BinaryOp::fold_constants()
+{
+    fold_expression(_lhs);
+    fold_expression(_rhs);
+}
+
+// a bool constant also reads as an int, codegen rejects the mix so folding must too
+bool BinaryOp::_both_i32()
+{
+    return _lhs->get_type() == irl::LlvmAtomic::i32 && _rhs->get_type() == irl::LlvmAtomic::i32;
+}
+
 Addition::Addition(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -173,6 +210,17 @@ std::unique_ptr<irl::IrlSegment> Addition::code_gen(irl::Context context)
     return segment;
 }
 
+std::unique_ptr<Expression> Addition::fold()
+{
+    auto lhs = _lhs->get_constant();
+    auto rhs = _rhs->get_constant();
+
+    if (!lhs || !rhs || !_both_i32())
+        return nullptr;
+
+    return std::make_unique<I32Constant>(wrap(int64_t(*lhs) + *rhs));
+}
+
 Subtraction::Subtraction(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -208,6 +256,17 @@ std::unique_ptr<irl::IrlSegment> Subtraction::code_gen(irl::Context context)
     return segment;
 }
 
+std::unique_ptr<Expression> Subtraction::fold()
+{
+    auto lhs = _lhs->get_constant();
+    auto rhs = _rhs->get_constant();
+
+    if (!lhs || !rhs || !_both_i32())
+        return nullptr;
+
+    return std::make_unique<I32Constant>(wrap(int64_t(*lhs) - *rhs));
+}
+
 Multiplication::Multiplication(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -243,6 +302,17 @@ std::unique_ptr<irl::IrlSegment> Multiplication::code_gen(irl::Context context)
     return segment;
 }
 
+std::unique_ptr<Expression> Multiplication::fold()
+{
+    auto lhs = _lhs->get_constant();
+    auto rhs = _rhs->get_constant();
+
+    if (!lhs || !rhs || !_both_i32())
+        return nullptr;
+
+    return std::make_unique<I32Constant>(wrap(int64_t(*lhs) * *rhs));
+}
+
 Division::Division(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -278,6 +348,18 @@ std::unique_ptr<irl::IrlSegment> Division::code_gen(irl::Context context)
     return segment;
 }
 
+std::unique_ptr<Expression> Division::fold()
+{
+    auto lhs = _lhs->get_constant();
+    auto rhs = _rhs->get_constant();
+
+    // division by zero and INT_MIN / -1 are left for the program to hit
+    if (!lhs || !rhs || !_both_i32() || *rhs == 0 || (*lhs == INT32_MIN && *rhs == -1))
+        return nullptr;
+
+    return std::make_unique<I32Constant>(*lhs / *rhs);
+}
+
 Compare::Compare(Compare::Code code, std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -360,7 +442,7 @@ std::unique_ptr<irl::IrlSegment> Compare::code_gen(irl::Context context)
         break;
 
     case Code::GE:
-        ct = irl::ICmp::CondT::sle;
+        ct = irl::ICmp::CondT::sge;
         break;
     }
 
@@ -373,6 +455,46 @@ std::unique_ptr<irl::IrlSegment> Compare::code_gen(irl::Context context)
     return segment;
 }
 
+std::unique_ptr<Expression> Compare::fold()
+{
+    auto lhs = _lhs->get_constant();
+    auto rhs = _rhs->get_constant();
+
+    if (!lhs || !rhs || !_both_i32())
+        return nullptr;
+
+    bool value = false;
+
+    switch (_code)
+    {
+    case Code::EQ:
+        value = *lhs == *rhs;
+        break;
+
+    case Code::NE:
+        value = *lhs != *rhs;
+        break;
+
+    case Code::LT:
+        value = *lhs < *rhs;
+        break;
+
+    case Code::LE:
+        value = *lhs <= *rhs;
+        break;
+
+    case Code::GT:
+        value = *lhs > *rhs;
+        break;
+
+    case Code::GE:
+        value = *lhs >= *rhs;
+        break;
+    }
+
+    return std::make_unique<BoolConstant>(value);
+}
+
 LogicalAnd::LogicalAnd(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -406,17 +528,29 @@ std::unique_ptr<irl::IrlSegment> LogicalAnd::code_gen(irl::Context context)
         segment->instructions.push_back(std::move(i));
     }
 
-    auto out_false = std::make_unique<irl::IntLiteral>();
-
-    out_false->tp = irl::LlvmAtomic::b;
-    out_false->value = 0;
-
     segment->out_value = rhs->out_value;
-    segment->out_false = std::move(out_false);
+    segment->out_false = _var_scope->get_constants()->get_bool(false);
 
     return segment;
 }
 
+std::unique_ptr<Expression> LogicalAnd::fold()
+{
+    // a kept operand must already be an i1, or the fold would skip the
+    // type check that code_gen does on the node
+    bool typed = _lhs->get_type() == _tp && _rhs->get_type() == _tp;
+
+    // the rhs is never evaluated after a false lhs, so it can go with its effects
+    if (auto lhs = _lhs->get_constant(); lhs && typed)
+        return *lhs ? std::move(_rhs) : std::make_unique<BoolConstant>(false);
+
+    // the lhs still has to run, but a true rhs does not change its value
+    if (auto rhs = _rhs->get_constant(); rhs && *rhs && typed)
+        return std::move(_lhs);
+
+    return nullptr;
+}
+
 LogicalOr::LogicalOr(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs):
     BinaryOp(std::move(lhs), std::move(rhs))
 {
@@ -431,13 +565,12 @@ std::string LogicalOr::print()
 std::unique_ptr<irl::IrlSegment> LogicalOr::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
-    auto ref_rhs = _var_scope->new_placeholder(irl::LlvmAtomic::v);
+    auto ref_rhs = _var_scope->new_temp(irl::LlvmAtomic::v);
 
     irl::Context lhs_context = context;
     lhs_context.ph_false = ref_rhs;
 
     auto lhs = _lhs->code_gen(lhs_context);
-    _var_scope->fix_placehoder(ref_rhs);
     auto rhs = _rhs->code_gen(context);
 
     for (auto& i: lhs->instructions)
@@ -453,23 +586,36 @@ std::unique_ptr<irl::IrlSegment> LogicalOr::code_gen(irl::Context context)
         segment->instructions.push_back(std::move(i));
     }
 
-    auto out_false = std::make_unique<irl::IntLiteral>();
-
-    out_false->tp = irl::LlvmAtomic::b;
-    out_false->value = 1;
-
     segment->out_value = rhs->out_value;
-    segment->out_false = std::move(out_false);
+    segment->out_false = _var_scope->get_constants()->get_bool(true);
 
     return segment;
 }
 
+std::unique_ptr<Expression> LogicalOr::fold()
+{
+    bool typed = _lhs->get_type() == _tp && _rhs->get_type() == _tp;
+
+    if (auto lhs = _lhs->get_constant(); lhs && typed)
+        return *lhs ? std::make_unique<BoolConstant>(true) : std::move(_rhs);
+
+    if (auto rhs = _rhs->get_constant(); rhs && !*rhs && typed)
+        return std::move(_lhs);
+
+    return nullptr;
+}
+
 AssignmentExpression::AssignmentExpression(std::string identifier, std::unique_ptr<Expression> inner):
     _identifier(std::move(identifier)),
     _inner(std::move(inner))
 {
 }
 
+void AssignmentExpression::fold_constants()
+{
+    fold_expression(_inner);
+}
+
 RegularAssignment::RegularAssignment(std::string identifier, std::unique_ptr<Expression> inner):
     AssignmentExpression(std::move(identifier), std::move(inner))
 {
@@ -484,7 +630,7 @@ std::unique_ptr<irl::IrlSegment> RegularAssignment::code_gen(irl::Context contex
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    auto ref = _var_scope->get_variable(_identifier);
+    auto ref = _var_scope->get_variable(_symbol);
 
     auto inner = _inner->code_gen(std::move(context));
     for (auto& i: inner->instructions)
@@ -492,7 +638,8 @@ std::unique_ptr<irl::IrlSegment> RegularAssignment::code_gen(irl::Context contex
         segment->instructions.push_back(std::move(i));
     }
 
-    segment->instructions.push_back(std::make_unique<irl::Store>(inner->out_value, std::move(ref), 4));
+    auto alignment = irl::atomic_alignment(ref->tp);
+    segment->instructions.push_back(std::make_unique<irl::Store>(inner->out_value, std::move(ref), alignment));
     segment->out_value = std::move(inner->out_value);
 
     return segment;
@@ -520,9 +667,7 @@ std::unique_ptr<irl::IrlSegment> BooleanCast::code_gen(irl::Context context)
         segment->instructions.push_back(std::move(i));
     }
 
-    auto zero = std::make_unique<irl::IntLiteral>();
-    zero->tp = irl::LlvmAtomic::i32;
-    zero->value = 0;
+    auto zero = _var_scope->get_constants()->get_int(irl::LlvmAtomic::i32, 0);
 
     segment->instructions.push_back(std::make_unique<irl::ICmp>(irl::ICmp::ne, ref, std::move(inner->out_value), std::move(zero), irl::LlvmAtomic::i32));
 
@@ -530,11 +675,29 @@ std::unique_ptr<irl::IrlSegment> BooleanCast::code_gen(irl::Context context)
     return segment;
 }
 
+void BooleanCast::fold_constants()
+{
+    fold_expression(_inner);
+}
+
+std::unique_ptr<Expression> BooleanCast::fold()
+{
+    if (auto inner = _inner->get_constant())
+        return std::make_unique<BoolConstant>(*inner != 0);
+
+    // casting an i1 again changes nothing
+    if (_inner->get_type() == irl::LlvmAtomic::b)
+        return std::move(_inner);
+
+    return nullptr;
+}
+
 ConditionalExpression::ConditionalExpression(std::unique_ptr<Expression> condition, std::unique_ptr<Expression> true_branch, std::unique_ptr<Expression> false_branch):
     _condition(std::move(condition)),
     _true_branch(std::move(true_branch)),
     _false_branch(std::move(false_branch))
 {
+    _tp = irl::LlvmAtomic::i32;
 }
 
 std::string ConditionalExpression::print()
@@ -580,11 +743,9 @@ std::unique_ptr<irl::IrlSegment> ConditionalExpression::code_gen(irl::Context co
     segment->instructions.push_back(std::make_unique<irl::Jump>(ref_end));
     segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_end)));
 
-    // TODO use node type
-    auto tp = irl::LlvmAtomic::i32;
-    auto out = _var_scope->new_temp(tp);
+    auto out = _var_scope->new_temp(_tp);
 
-    auto phi = std::make_unique<irl::Phi>(out, tp);
+    auto phi = std::make_unique<irl::Phi>(out, _tp);
     phi->add_branch(std::move(true_branch->out_value), std::move(ref_true));
     phi->add_branch(std::move(false_branch->out_value), std::move(ref_false));
 
@@ -594,6 +755,26 @@ std::unique_ptr<irl::IrlSegment> ConditionalExpression::code_gen(irl::Context co
     return segment;
 }
 
+void ConditionalExpression::fold_constants()
+{
+    fold_expression(_condition);
+    fold_expression(_true_branch);
+    fold_expression(_false_branch);
+}
+
+std::unique_ptr<Expression> ConditionalExpression::fold()
+{
+    // both branches go through the phi in code_gen, so the dropped one
+    // has to be checked too, or folding would accept what -O0 rejects
+    if (_true_branch->get_type() != _tp || _false_branch->get_type() != _tp)
+        return nullptr;
+
+    if (auto condition = _condition->get_constant())
+        return *condition ? std::move(_true_branch) : std::move(_false_branch);
+
+    return nullptr;
+}
+
 FCall::FCall(std::string id, std::vector<std::unique_ptr<Expression>> params):
     _id(id),
     _params(std::move(params))
@@ -658,6 +839,12 @@ std::unique_ptr<irl::IrlSegment> FCall::code_gen(irl::Context context)
     return segment;
 }
 
+void FCall::fold_constants()
+{
+    for (auto& param: _params)
+        fold_expression(param);
+}
+
 // void FCall::add_param(std::unique_ptr<Expression> param)
 // {
 //     _params.push_back(std::move(param));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include <pseudoc/ast/base.hpp>
@@ -20,8 +21,24 @@ namespace ast
             _var_scope = std::move(var_scope);
             _ftable = std::move(ftable);
         }
+
+        // value of the node when it is a constant
+        virtual std::optional<int> get_constant()
+        {
+            return std::nullopt;
+        }
+
+        // node to use in place of this one, once the children are folded: a
+        // constant, or the child the node reduces to. nullptr keeps the node
+        virtual std::unique_ptr<Expression> fold()
+        {
+            return nullptr;
+        }
     };
 
+    // folds the whole tree of expr, replacing expr when it folds
+    void fold_expression(std::unique_ptr<Expression>& expr);
+
     class I32Constant : public Expression
     {
     public:
@@ -30,10 +47,33 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        std::optional<int> get_constant() override
+        {
+            return _value;
+        }
+
     private:
         int _value;
     };
 
+    // the i1 result of a folded comparison or logical expression
+    class BoolConstant : public Expression
+    {
+    public:
+        BoolConstant(bool value);
+
+        std::string print() override;
+        std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::optional<int> get_constant() override
+        {
+            return _value;
+        }
+
+    private:
+        bool _value;
+    };
+
     class F32Constant : public Expression
     {
     public:
@@ -54,8 +94,17 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
+        {
+            _symbol = var_scope->intern(_identifier);
+
+            _var_scope = std::move(var_scope);
+            _ftable = std::move(ftable);
+        }
+
     private:
         std::string _identifier;
+        int _symbol;
     };
 
     class PreIncrement : public Expression
@@ -66,8 +115,17 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
+        {
+            _symbol = var_scope->intern(_identifier);
+
+            _var_scope = std::move(var_scope);
+            _ftable = std::move(ftable);
+        }
+
     private:
         std::string _identifier;
+        int _symbol;
         int _value;
     };
 
@@ -79,8 +137,17 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
+        {
+            _symbol = var_scope->intern(_identifier);
+
+            _var_scope = std::move(var_scope);
+            _ftable = std::move(ftable);
+        }
+
     private:
         std::string _identifier;
+        int _symbol;
         int _value;
     };
 
@@ -100,8 +167,12 @@ namespace ast
             _var_scope = std::move(var_scope);
             _ftable = std::move(ftable);
         }
-        
+
+        void fold_constants() override;
+
     protected:
+        bool _both_i32();
+
         std::unique_ptr<Expression> _lhs;
         std::unique_ptr<Expression> _rhs;
     };
@@ -113,6 +184,8 @@ namespace ast
 
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::unique_ptr<Expression> fold() override;
     };
 
     class Subtraction : public BinaryOp
@@ -122,6 +195,8 @@ namespace ast
 
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::unique_ptr<Expression> fold() override;
     };
 
     class Multiplication : public BinaryOp
@@ -131,6 +206,8 @@ namespace ast
 
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::unique_ptr<Expression> fold() override;
     };
 
     class Division : public BinaryOp
@@ -140,6 +217,8 @@ namespace ast
 
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::unique_ptr<Expression> fold() override;
     };
 
     class Compare : public BinaryOp
@@ -160,6 +239,8 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        std::unique_ptr<Expression> fold() override;
+
     private:
         Code _code;
     };
@@ -171,6 +252,8 @@ namespace ast
 
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::unique_ptr<Expression> fold() override;
     };
 
     class LogicalOr : public BinaryOp
@@ -180,6 +263,8 @@ namespace ast
 
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
+
+        std::unique_ptr<Expression> fold() override;
     };
 
     class AssignmentExpression : public Expression
@@ -193,13 +278,17 @@ namespace ast
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
             _inner->set_variable_scope(var_scope, ftable);
+            _symbol = var_scope->intern(_identifier);
 
             _var_scope = std::move(var_scope);
             _ftable = std::move(ftable);
         }
 
+        void fold_constants() override;
+
     protected:
         std::string _identifier;
+        int _symbol;
         std::unique_ptr<Expression> _inner;
     };
 
@@ -228,6 +317,9 @@ namespace ast
             _ftable = std::move(ftable);
         }
 
+        void fold_constants() override;
+        std::unique_ptr<Expression> fold() override;
+
     private:
         std::unique_ptr<Expression> _inner;
     };
@@ -250,6 +342,9 @@ namespace ast
             _ftable = std::move(ftable);
         }
 
+        void fold_constants() override;
+        std::unique_ptr<Expression> fold() override;
+
     private:
         std::unique_ptr<Expression> _condition;
         std::unique_ptr<Expression> _true_branch;
@@ -275,6 +370,8 @@ namespace ast
             _ftable = std::move(ftable);
         }
 
+        void fold_constants() override;
+
     private:
         std::string _id;
         std::vector<std::unique_ptr<Expression>> _params;
@@ -30,53 +30,42 @@ std::unique_ptr<irl::IrlSegment> IfStatement::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    context.ph_true = _var_scope->new_placeholder(irl::LlvmAtomic::v);
-    context.ph_false = _var_scope->new_placeholder(irl::LlvmAtomic::v);
+    auto ref_true = _var_scope->new_temp(irl::LlvmAtomic::v);
+    auto ref_false = _var_scope->new_temp(irl::LlvmAtomic::v);
 
-    auto condition = _condition->code_gen(context);
+    irl::Context ccontext = context;
+    ccontext.ph_true = ref_true;
+    ccontext.ph_false = ref_false;
+
+    auto condition = _condition->code_gen(ccontext);
+    auto on_true = _on_true->code_gen(context);
 
     for (auto& i: condition->instructions)
     {
         segment->instructions.push_back(std::move(i));
     }
 
-    _var_scope->fix_placehoder(context.ph_true);
-    auto on_true = _on_true->code_gen(context);
+    segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), ref_true, ref_false));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_true)));
 
-    _var_scope->fix_placehoder(context.ph_false);
+    for (auto& i: on_true->instructions)
+    {
+        segment->instructions.push_back(std::move(i));
+    }
 
     if (!_on_false)
     {
-        auto label_end = std::make_unique<irl::Label>(context.ph_false);
-
-        segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), context.ph_false, context.ph_false));
-        segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_true)));
-
-        for (auto& i: on_true->instructions)
-        {
-            segment->instructions.push_back(std::move(i));
-        }
-
-        segment->instructions.push_back(std::make_unique<irl::Jump>(context.ph_false));
-        segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_false)));
+        segment->instructions.push_back(std::make_unique<irl::Jump>(ref_false));
+        segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_false)));
 
         return segment;
     }
 
-    auto on_false = _on_false->code_gen(context);
-
+    auto on_false = _on_false->code_gen(std::move(context));
     auto ref_end = _var_scope->new_temp(irl::LlvmAtomic::v);
 
-    segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), context.ph_true, context.ph_false));
-    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_true)));
-
-    for (auto& i: on_true->instructions)
-    {
-        segment->instructions.push_back(std::move(i));
-    }
-
     segment->instructions.push_back(std::make_unique<irl::Jump>(ref_end));
-    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_false)));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_false)));
 
     for (auto& i: on_false->instructions)
     {
@@ -89,6 +78,15 @@ std::unique_ptr<irl::IrlSegment> IfStatement::code_gen(irl::Context context)
     return segment;
 }
 
+void IfStatement::fold_constants()
+{
+    fold_expression(_condition);
+    _on_true->fold_constants();
+
+    if (_on_false)
+        _on_false->fold_constants();
+}
+
 void IfStatement::set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable)
 {
     _condition->set_variable_scope(var_scope, ftable);
@@ -117,24 +115,22 @@ std::unique_ptr<irl::IrlSegment> WhileLoop::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    context.ph_true = _var_scope->new_placeholder(irl::LlvmAtomic::v);
-    context.ph_false = _var_scope->new_placeholder(irl::LlvmAtomic::v);
+    auto ref_condition = _var_scope->new_temp(irl::LlvmAtomic::v);
+    auto ref_body = _var_scope->new_temp(irl::LlvmAtomic::v);
+    auto ref_end = _var_scope->new_temp(irl::LlvmAtomic::v);
 
     // prepare refs and code generation
-    auto ref_condition = _var_scope->new_temp(irl::LlvmAtomic::v);
-    auto condition = _condition->code_gen(context);
+    context.ph_true = ref_body;
+    context.ph_false = ref_end;
 
-    // auto ref_end = _var_scope->new_placeholder(irl::LlvmAtomic::v);
+    auto condition = _condition->code_gen(context);
 
     irl::Context lcontext;
-    lcontext.break_label = context.ph_false;
+    lcontext.break_label = ref_end;
     lcontext.continue_label = ref_condition;
 
-    _var_scope->fix_placehoder(context.ph_true);
     auto body = _body->code_gen(lcontext);
 
-    _var_scope->fix_placehoder(context.ph_false);
-
     // build code segment
     segment->instructions.push_back(std::make_unique<irl::Jump>(ref_condition));
     segment->instructions.push_back(std::make_unique<irl::Label>(ref_condition));
@@ -144,8 +140,8 @@ std::unique_ptr<irl::IrlSegment> WhileLoop::code_gen(irl::Context context)
         segment->instructions.push_back(std::move(i));
     }
 
-    segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), context.ph_true, context.ph_false));
-    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_true)));
+    segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), ref_body, ref_end));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_body)));
 
     for (auto& i: body->instructions)
     {
@@ -153,11 +149,17 @@ std::unique_ptr<irl::IrlSegment> WhileLoop::code_gen(irl::Context context)
     }
 
     segment->instructions.push_back(std::make_unique<irl::Jump>(std::move(ref_condition)));
-    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_false)));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_end)));
 
     return segment;
 }
 
+void WhileLoop::fold_constants()
+{
+    fold_expression(_condition);
+    _body->fold_constants();
+}
+
 void WhileLoop::set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable)
 {
     _condition->set_variable_scope(var_scope, ftable);
@@ -196,24 +198,30 @@ std::unique_ptr<irl::IrlSegment> ForLoop::code_gen(irl::Context context)
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
-    context.ph_true = _var_scope->new_placeholder(irl::LlvmAtomic::v);
-    context.ph_false = _var_scope->new_placeholder(irl::LlvmAtomic::v);
+    auto ref_condition = _var_scope->new_temp(irl::LlvmAtomic::v);
+    auto ref_body = _var_scope->new_temp(irl::LlvmAtomic::v);
+    auto ref_increment = _var_scope->new_temp(irl::LlvmAtomic::v);
+    auto ref_end = _var_scope->new_temp(irl::LlvmAtomic::v);
+
+    // the initializer declarations are only visible inside the loop
+    _var_scope->push_block();
 
     // prepare refs and code generation
     auto initializer = _initializer->code_gen(context);
-    auto ref_condition = _var_scope->new_temp(irl::LlvmAtomic::v);
+
+    context.ph_true = ref_body;
+    context.ph_false = ref_end;
+
     auto condition = _condition->code_gen(context);
+    auto increment = _increment->code_gen(context);
 
     irl::Context lcontext;
-    lcontext.break_label = context.ph_false;
-    lcontext.continue_label = ref_condition;
+    lcontext.break_label = ref_end;
+    lcontext.continue_label = ref_increment;
 
-    _var_scope->fix_placehoder(context.ph_true);
     auto body = _body->code_gen(lcontext);
-    auto ref_increment = _var_scope->new_temp(irl::LlvmAtomic::v);
-    auto increment = _increment->code_gen(context);
 
-    _var_scope->fix_placehoder(context.ph_false);
+    _var_scope->pop_block();
 
     // build code segment
     for (auto& i: initializer->instructions)
@@ -229,8 +237,8 @@ std::unique_ptr<irl::IrlSegment> ForLoop::code_gen(irl::Context context)
         segment->instructions.push_back(std::move(i));
     }
 
-    segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), context.ph_true, context.ph_false));
-    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_true)));
+    segment->instructions.push_back(std::make_unique<irl::JumpC>(std::move(condition->out_value), ref_body, ref_end));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_body)));
 
     for (auto& i: body->instructions)
     {
@@ -238,7 +246,7 @@ std::unique_ptr<irl::IrlSegment> ForLoop::code_gen(irl::Context context)
     }
 
     segment->instructions.push_back(std::make_unique<irl::Jump>(ref_increment));
-    segment->instructions.push_back(std::make_unique<irl::Label>(ref_increment));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_increment)));
 
     for (auto& i: increment->instructions)
     {
@@ -246,11 +254,19 @@ std::unique_ptr<irl::IrlSegment> ForLoop::code_gen(irl::Context context)
     }
 
     segment->instructions.push_back(std::make_unique<irl::Jump>(std::move(ref_condition)));
-    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(context.ph_false)));
+    segment->instructions.push_back(std::make_unique<irl::Label>(std::move(ref_end)));
 
     return segment;
 }
 
+void ForLoop::fold_constants()
+{
+    _initializer->fold_constants();
+    fold_expression(_condition);
+    fold_expression(_increment);
+    _body->fold_constants();
+}
+
 std::string Continue::print()
 {
     return "continue\n";
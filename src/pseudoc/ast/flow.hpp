@@ -13,6 +13,8 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override;
 
     private:
@@ -29,6 +31,8 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override;
 
     private:
@@ -44,6 +48,8 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override;
 
     private:
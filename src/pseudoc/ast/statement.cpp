@@ -21,10 +21,10 @@ std::unique_ptr<irl::IrlSegment> VariableDeclaration::code_gen(irl::Context cont
     auto tp = irl::LlvmAtomic::i32;
 
     // add variable & get temporary
-    auto ref = _var_scope->add_variable(_identifier, tp);
+    auto ref = _var_scope->add_variable(_symbol, tp);
 
     // alloc instruction
-    segment->instructions.push_back(std::make_unique<irl::Alloca>(ref, 4));
+    segment->instructions.push_back(std::make_unique<irl::Alloca>(ref, irl::atomic_alignment(tp)));
 
     if (_initializer)
     {
@@ -38,12 +38,18 @@ std::unique_ptr<irl::IrlSegment> VariableDeclaration::code_gen(irl::Context cont
         }
 
         // store value on variable
-        segment->instructions.push_back(std::make_unique<irl::Store>(inner->out_value, ref, 4));
+        segment->instructions.push_back(std::make_unique<irl::Store>(inner->out_value, ref, irl::atomic_alignment(tp)));
     }
 
     return segment;
 }
 
+void VariableDeclaration::fold_constants()
+{
+    if (_initializer)
+        fold_expression(_initializer);
+}
+
 DeclarationStatement::DeclarationStatement(std::unique_ptr<VariableDeclaration> decl)
 {
     _decls.push_back(std::move(decl));
@@ -80,6 +86,12 @@ std::unique_ptr<irl::IrlSegment> DeclarationStatement::code_gen(irl::Context con
     return segment;
 }
 
+void DeclarationStatement::fold_constants()
+{
+    for (auto& decl: _decls)
+        decl->fold_constants();
+}
+
 void DeclarationStatement::add_variable(std::unique_ptr<VariableDeclaration> decl)
 {
     _decls.push_back(std::move(decl));
@@ -101,6 +113,11 @@ std::unique_ptr<irl::IrlSegment> ExpressionStatement::code_gen(irl::Context cont
     return segment;
 }
 
+void ExpressionStatement::fold_constants()
+{
+    fold_expression(_expr);
+}
+
 ReturnStatement::ReturnStatement(std::unique_ptr<Expression> expr):
     _expr(std::move(expr))
 {
@@ -121,11 +138,17 @@ std::unique_ptr<irl::IrlSegment> ReturnStatement::code_gen(irl::Context context)
         segment->instructions.push_back(std::move(i));
     }
 
-    segment->instructions.push_back(std::make_unique<irl::Ret>(std::move(expr->out_value), _expr->get_type()));
+    auto tp = expr->out_value->tp;
+    segment->instructions.push_back(std::make_unique<irl::Ret>(std::move(expr->out_value), tp));
 
     return segment;
 }
 
+void ReturnStatement::fold_constants()
+{
+    fold_expression(_expr);
+}
+
 void CompoundStatement::add_statement(std::unique_ptr<Statement> statement)
 {
     _statements.push_back(std::move(statement));
@@ -148,6 +171,9 @@ std::unique_ptr<irl::IrlSegment> CompoundStatement::code_gen(irl::Context contex
 {
     auto segment = std::make_unique<irl::IrlSegment>();
 
+    if (_opens_block)
+        _var_scope->push_block();
+
     for (auto& statement: _statements)
     {
         auto inner = statement->code_gen(context);
@@ -158,5 +184,14 @@ std::unique_ptr<irl::IrlSegment> CompoundStatement::code_gen(irl::Context contex
         }
     }
 
+    if (_opens_block)
+        _var_scope->pop_block();
+
     return segment;
-}
\ No newline at end of file
+}
+
+void CompoundStatement::fold_constants()
+{
+    for (auto& statement: _statements)
+        statement->fold_constants();
+}
@@ -30,17 +30,22 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
             if (_initializer)
                 _initializer->set_variable_scope(var_scope, ftable);
 
+            _symbol = var_scope->intern(_identifier);
+
             _var_scope = std::move(var_scope);
             _ftable = std::move(ftable);
         }
 
     private:
         std::string _identifier;
+        int _symbol;
         std::unique_ptr<Expression> _initializer;
     };
 
@@ -52,6 +57,8 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
             for (auto& decl: _decls)
@@ -77,6 +84,8 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
             _expr->set_variable_scope(var_scope, ftable);
@@ -96,9 +105,11 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
-            _expr->set_variable_scope(var_scope, _ftable);
+            _expr->set_variable_scope(var_scope, ftable);
             _var_scope = std::move(var_scope);
             _ftable = std::move(ftable);
         }
@@ -115,6 +126,10 @@ namespace ast
         std::string print() override;
         std::unique_ptr<irl::IrlSegment> code_gen(irl::Context context) override;
 
+        void fold_constants() override;
+
+        // shares the block of the parent (used by function bodies, so the
+        // params and the top level declarations live in the same block)
         void forward_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable)
         {
             _var_scope = std::move(var_scope);
@@ -126,10 +141,12 @@ namespace ast
 
         void set_variable_scope(std::shared_ptr<VariableScope> var_scope, std::shared_ptr<FunctionTable> ftable) override
         {
-            forward_variable_scope(std::make_shared<VariableScope>(std::move(var_scope)), std::move(ftable));
+            _opens_block = true;
+            forward_variable_scope(std::move(var_scope), std::move(ftable));
         }
 
     private:
         std::vector<std::unique_ptr<Statement>> _statements;
+        bool _opens_block = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <pseudoc/irl/analyses.hpp>
+
+using namespace irl;
+
+Analyses::Analyses(IrlSegment& function):
+    _function(function)
+{
+}
+
+Cfg& Analyses::get_cfg()
+{
+    if (!_cfg)
+        _cfg = std::make_unique<Cfg>(_function);
+
+    return *_cfg;
+}
+
+const DominatorTree& Analyses::get_dominators()
+{
+    if (!_dominators)
+        _dominators = std::make_unique<DominatorTree>(get_cfg());
+
+    return *_dominators;
+}
+
+const LoopInfo& Analyses::get_loops()
+{
+    if (!_loops)
+        _loops = std::make_unique<LoopInfo>(get_cfg(), get_dominators());
+
+    return *_loops;
+}
+
+const Liveness& Analyses::get_liveness()
+{
+    if (!_liveness)
+        _liveness = std::make_unique<Liveness>(_function, get_cfg());
+
+    return *_liveness;
+}
+
+void Analyses::invalidate()
+{
+    _liveness.reset();
+    _loops.reset();
+    _dominators.reset();
+    _cfg.reset();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/dominators.hpp>
+#include <pseudoc/irl/liveness.hpp>
+#include <pseudoc/irl/loops.hpp>
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // analyses of a renumbered function, each built on its first query and
+    // kept until the function changes. whoever changes it calls invalidate,
+    // which also drops the analyses built on top of the cfg
+    class Analyses
+    {
+    public:
+        Analyses(IrlSegment& function);
+
+        Cfg& get_cfg();
+        const DominatorTree& get_dominators();
+        const LoopInfo& get_loops();
+        const Liveness& get_liveness();
+
+        void invalidate();
+
+    private:
+        IrlSegment& _function;
+
+        std::unique_ptr<Cfg> _cfg;
+        std::unique_ptr<DominatorTree> _dominators;
+        std::unique_ptr<LoopInfo> _loops;
+        std::unique_ptr<Liveness> _liveness;
+    };
+}
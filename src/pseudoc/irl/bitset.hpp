@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace irl
+{
+    // fixed size set of small integers (value ids, block indices) packed
+    // 64 to a word. the set operations are straight loops over the words,
+    // with no branch on the data, so the compiler turns them into vector
+    // code, and the changed flags of the dataflow come out of the same pass
+    class BitSet
+    {
+    public:
+        BitSet() = default;
+
+        explicit BitSet(int size):
+            _size(size),
+            _words((size + 63) / 64, 0)
+        {
+        }
+
+        int size() const
+        {
+            return _size;
+        }
+
+        bool test(int bit) const
+        {
+            return _words[bit >> 6] >> (bit & 63) & 1;
+        }
+
+        void set(int bit)
+        {
+            _words[bit >> 6] |= uint64_t(1) << (bit & 63);
+        }
+
+        void reset(int bit)
+        {
+            _words[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+        }
+
+        void clear()
+        {
+            for (auto& word: _words)
+                word = 0;
+        }
+
+        bool empty() const
+        {
+            uint64_t any = 0;
+
+            for (auto word: _words)
+                any |= word;
+
+            return any == 0;
+        }
+
+        int count() const
+        {
+            int count = 0;
+
+            for (auto word: _words)
+                count += __builtin_popcountll(word);
+
+            return count;
+        }
+
+        // this |= other, true when a bit was added
+        bool unite(const BitSet& other)
+        {
+            uint64_t* __restrict words = _words.data();
+            const uint64_t* __restrict others = other._words.data();
+            uint64_t changed = 0;
+
+            for (size_t i = 0; i < _words.size(); i++)
+            {
+                uint64_t word = words[i] | others[i];
+                changed |= word ^ words[i];
+                words[i] = word;
+            }
+
+            return changed != 0;
+        }
+
+        // this &= ~other
+        void subtract(const BitSet& other)
+        {
+            uint64_t* __restrict words = _words.data();
+            const uint64_t* __restrict others = other._words.data();
+
+            for (size_t i = 0; i < _words.size(); i++)
+                words[i] &= ~others[i];
+        }
+
+        // this = gen | (in & ~kill), the transfer function of the bit
+        // vector problems. true when the set changed
+        bool assign_transfer(const BitSet& gen, const BitSet& in, const BitSet& kill)
+        {
+            uint64_t* __restrict words = _words.data();
+            const uint64_t* __restrict gens = gen._words.data();
+            const uint64_t* __restrict ins = in._words.data();
+            const uint64_t* __restrict kills = kill._words.data();
+            uint64_t changed = 0;
+
+            for (size_t i = 0; i < _words.size(); i++)
+            {
+                uint64_t word = gens[i] | (ins[i] & ~kills[i]);
+                changed |= word ^ words[i];
+                words[i] = word;
+            }
+
+            return changed != 0;
+        }
+
+        // calls f with every bit set, in increasing order
+        template <typename F>
+        void for_each(F f) const
+        {
+            for (size_t i = 0; i < _words.size(); i++)
+            {
+                for (uint64_t word = _words[i]; word != 0; word &= word - 1)
+                    f(static_cast<int>(i * 64 + __builtin_ctzll(word)));
+            }
+        }
+
+        bool operator == (const BitSet& other) const
+        {
+            return _size == other._size && _words == other._words;
+        }
+
+        bool operator != (const BitSet& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        int _size = 0;
+        std::vector<uint64_t> _words;
+    };
+}
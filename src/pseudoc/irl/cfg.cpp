@@ -0,0 +1,195 @@
+#include <pseudoc/irl/cfg.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace irl;
+
+Cfg::Cfg(IrlSegment& function)
+{
+    _build_blocks(function);
+    _build_edges(function);
+    _build_rpo();
+}
+
+int Cfg::get_block_of(const Variable& label) const
+{
+    if (label.id < 0 || label.id >= static_cast<int>(_block_of_label.size()))
+        return -1;
+
+    return _block_of_label[label.id];
+}
+
+int Cfg::get_edge(int from, int to) const
+{
+    for (int e = _succ_offsets[from]; e < _succ_offsets[from + 1]; e++)
+    {
+        if (_succs[e] == to)
+            return e;
+    }
+
+    return -1;
+}
+
+void Cfg::_build_blocks(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.empty() || instructions.front()->get_opcode() != Instruction::DEF)
+        throw std::logic_error("control flow graph built over something that is not a function");
+
+    int max_id = -1;
+
+    for (size_t i = 1; i < instructions.size(); i++)
+    {
+        auto op = instructions[i]->get_opcode();
+
+        if (op == Instruction::END_DEF)
+            break;
+
+        if (op != Instruction::LABEL)
+            continue;
+
+        auto label = static_cast<Label*>(instructions[i].get())->get_ref();
+
+        if (label->id < 0)
+            throw std::logic_error("control flow graph built before irl::renumber");
+
+        if (!_blocks.empty())
+            _blocks.back().end = i;
+
+        _blocks.push_back({ label, i, i });
+        max_id = std::max(max_id, label->id);
+    }
+
+    if (_blocks.empty() || _blocks.front().begin != 1)
+        throw std::logic_error("function without an entry label");
+
+    size_t end = 1;
+
+    while (instructions[end]->get_opcode() != Instruction::END_DEF)
+        end++;
+
+    _blocks.back().end = end;
+
+    _block_of_label.assign(max_id + 1, -1);
+
+    for (int b = 0; b < size(); b++)
+        _block_of_label[_blocks[b].label->id] = b;
+}
+
+void Cfg::_build_edges(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+    int n = size();
+
+    auto target = [this](const std::shared_ptr<Variable>& label)
+    {
+        int b = get_block_of(*label);
+
+        if (b < 0)
+            throw std::logic_error("jump to a label outside the function");
+
+        return b;
+    };
+
+    _succ_offsets.assign(n + 1, 0);
+    _succs.reserve(2 * n);
+
+    for (int b = 0; b < n; b++)
+    {
+        auto& block = _blocks[b];
+        auto last = instructions[block.end - 1].get();
+
+        switch (last->get_opcode())
+        {
+        case Instruction::JUMP:
+            _succs.push_back(target(static_cast<Jump*>(last)->get_target()));
+            break;
+
+        case Instruction::JUMPC:
+        {
+            auto jump = static_cast<JumpC*>(last);
+            int on_true = target(jump->get_on_true());
+            int on_false = target(jump->get_on_false());
+
+            _succs.push_back(on_true);
+
+            if (on_false != on_true)
+                _succs.push_back(on_false);
+
+            break;
+        }
+
+        case Instruction::RET:
+            break;
+
+        default:
+            // falls through to the next block
+            if (b + 1 < n)
+                _succs.push_back(b + 1);
+        }
+
+        _succ_offsets[b + 1] = _succs.size();
+    }
+
+    // predecessors are the transposed edge list, counted then scattered
+    _pred_offsets.assign(n + 1, 0);
+
+    for (int s: _succs)
+        _pred_offsets[s + 1]++;
+
+    for (int b = 0; b < n; b++)
+        _pred_offsets[b + 1] += _pred_offsets[b];
+
+    _preds.resize(_succs.size());
+    std::vector<int> fill(_pred_offsets.begin(), _pred_offsets.end() - 1);
+
+    for (int b = 0; b < n; b++)
+    {
+        for (int s: get_successors(b))
+            _preds[fill[s]++] = b;
+    }
+}
+
+void Cfg::_build_rpo()
+{
+    int n = size();
+
+    _rpo.clear();
+    _rpo.reserve(n);
+    _rpo_index.assign(n, -1);
+
+    // iterative dfs, each frame keeps the next successor to visit
+    std::vector<std::pair<int, int>> stack;
+    std::vector<bool> visited(n, false);
+
+    stack.push_back({ 0, _succ_offsets[0] });
+    visited[0] = true;
+
+    while (!stack.empty())
+    {
+        auto& frame = stack.back();
+
+        if (frame.second < _succ_offsets[frame.first + 1])
+        {
+            int s = _succs[frame.second++];
+
+            if (!visited[s])
+            {
+                visited[s] = true;
+                stack.push_back({ s, _succ_offsets[s] });
+            }
+
+            continue;
+        }
+
+        _rpo.push_back(frame.first);
+        stack.pop_back();
+    }
+
+    std::reverse(_rpo.begin(), _rpo.end());
+
+    for (size_t i = 0; i < _rpo.size(); i++)
+        _rpo_index[_rpo[i]] = i;
+}
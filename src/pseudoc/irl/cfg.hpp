@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    struct BasicBlock
+    {
+        std::shared_ptr<Variable> label;
+
+        // instructions [begin, end) of the function, begin is the label
+        // and end - 1 the terminator
+        size_t begin;
+        size_t end;
+    };
+
+    // contiguous run of block indices
+    struct BlockRange
+    {
+        const int* first;
+        const int* last;
+
+        const int* begin() const { return first; }
+        const int* end() const { return last; }
+        size_t size() const { return last - first; }
+    };
+
+    // control flow graph of a function segment (Def ... EndDef), which must
+    // have gone through irl::renumber so every block starts with a numbered
+    // label. successors and predecessors are kept in compact adjacency
+    // arrays (one offset table and one edge list per direction), and the
+    // whole build is linear in the number of instructions
+    class Cfg
+    {
+    public:
+        Cfg(IrlSegment& function);
+
+        int size() const
+        {
+            return _blocks.size();
+        }
+
+        BasicBlock& get_block(int block)
+        {
+            return _blocks[block];
+        }
+
+        BlockRange get_successors(int block) const
+        {
+            return { _succs.data() + _succ_offsets[block], _succs.data() + _succ_offsets[block + 1] };
+        }
+
+        BlockRange get_predecessors(int block) const
+        {
+            return { _preds.data() + _pred_offsets[block], _preds.data() + _pred_offsets[block + 1] };
+        }
+
+        // edges are numbered by their position in the successor lists
+        int edge_count() const
+        {
+            return _succs.size();
+        }
+
+        // index of the edge from -> to, -1 when there is none
+        int get_edge(int from, int to) const;
+
+        // block starting with the label, -1 when it is not a label of this function
+        int get_block_of(const Variable& label) const;
+
+        // reachable blocks in reverse postorder, the entry block first
+        const std::vector<int>& get_rpo() const
+        {
+            return _rpo;
+        }
+
+        // position of the block on get_rpo(), -1 when it is unreachable
+        int get_rpo_index(int block) const
+        {
+            return _rpo_index[block];
+        }
+
+        bool is_reachable(int block) const
+        {
+            return _rpo_index[block] >= 0;
+        }
+
+    private:
+        std::vector<BasicBlock> _blocks;
+        std::vector<int> _block_of_label;
+
+        std::vector<int> _succ_offsets;
+        std::vector<int> _succs;
+        std::vector<int> _pred_offsets;
+        std::vector<int> _preds;
+
+        std::vector<int> _rpo;
+        std::vector<int> _rpo_index;
+
+        void _build_blocks(IrlSegment& function);
+        void _build_edges(IrlSegment& function);
+        void _build_rpo();
+    };
+}
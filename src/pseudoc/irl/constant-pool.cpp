@@ -0,0 +1,95 @@
+#include <pseudoc/irl/constant-pool.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace irl;
+
+// i8 300 and i8 44 are the same constant
+long ConstantPool::normalize(LlvmAtomic tp, long value)
+{
+    switch (tp)
+    {
+    case LlvmAtomic::b:
+        return value & 1;
+
+    case LlvmAtomic::i8:
+        return static_cast<int8_t>(value);
+
+    case LlvmAtomic::i16:
+        return static_cast<int16_t>(value);
+
+    case LlvmAtomic::i32:
+        return static_cast<int32_t>(value);
+
+    case LlvmAtomic::i64:
+        return value;
+
+    default:
+        throw std::logic_error("invalid type for an integer constant");
+    }
+}
+
+std::shared_ptr<IntLiteral> ConstantPool::get_int(LlvmAtomic tp, long value)
+{
+    value = normalize(tp, value);
+
+    Key key { tp, static_cast<uint64_t>(value) };
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _ints.find(key);
+
+    if (it != _ints.end())
+        return it->second;
+
+    auto literal = std::make_shared<IntLiteral>();
+    literal->tp = tp;
+    literal->value = value;
+
+    _ints.emplace(key, literal);
+    return literal;
+}
+
+std::shared_ptr<FloatLiteral> ConstantPool::get_float(float value)
+{
+    // floats are kept widened to double, the way llvm spells them
+    double widened = value;
+    uint64_t bits;
+    std::memcpy(&bits, &widened, sizeof(bits));
+
+    Key key { LlvmAtomic::fp, bits };
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _floats.find(key);
+
+    if (it != _floats.end())
+        return it->second;
+
+    auto literal = std::make_shared<FloatLiteral>();
+    literal->tp = LlvmAtomic::fp;
+    literal->value = widened;
+
+    _floats.emplace(key, literal);
+    return literal;
+}
+
+std::shared_ptr<FloatLiteral> ConstantPool::get_double(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    Key key { LlvmAtomic::db, bits };
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _floats.find(key);
+
+    if (it != _floats.end())
+        return it->second;
+
+    auto literal = std::make_shared<FloatLiteral>();
+    literal->tp = LlvmAtomic::db;
+    literal->value = value;
+
+    _floats.emplace(key, literal);
+    return literal;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <pseudoc/irl/type.hpp>
+#include <pseudoc/irl/value.hpp>
+
+namespace irl
+{
+    // interns literals per module, so every (type, value) pair maps to a
+    // single shared handle and constants can be compared by identity.
+    // it is the only module state written during codegen, so it is locked
+    // to let function bodies be generated concurrently
+    class ConstantPool
+    {
+    public:
+        std::shared_ptr<IntLiteral> get_int(LlvmAtomic tp, long value);
+        std::shared_ptr<FloatLiteral> get_float(float value);
+        std::shared_ptr<FloatLiteral> get_double(double value);
+
+        std::shared_ptr<IntLiteral> get_bool(bool value)
+        {
+            return get_int(LlvmAtomic::b, value);
+        }
+
+        // truncates the value to the width of the type, sign extended back to a long
+        static long normalize(LlvmAtomic tp, long value);
+
+    private:
+        struct Key
+        {
+            LlvmAtomic tp;
+            uint64_t bits;
+
+            bool operator == (const Key& other) const
+            {
+                return tp == other.tp && bits == other.bits;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator () (const Key& key) const
+            {
+                return std::hash<uint64_t>()(key.bits) ^ (static_cast<size_t>(key.tp) * 0x9e3779b97f4a7c15ull);
+            }
+        };
+
+        std::mutex _lock;
+        std::unordered_map<Key, std::shared_ptr<IntLiteral>, KeyHash> _ints;
+        std::unordered_map<Key, std::shared_ptr<FloatLiteral>, KeyHash> _floats;
+    };
+}
@@ -0,0 +1,185 @@
+#include <pseudoc/irl/dce.hpp>
+
+#include <algorithm>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+static int id_of(const std::shared_ptr<Value>& value)
+{
+    auto var = dynamic_cast<Variable*>(value.get());
+    return var ? var->id : -1;
+}
+
+static bool has_effect(Instruction& instruction)
+{
+    switch (instruction.get_opcode())
+    {
+    case Instruction::STORE:
+    case Instruction::CALL:
+    case Instruction::DEF:
+    case Instruction::DECLARE:
+    case Instruction::END_DEF:
+    case Instruction::RET:
+    case Instruction::LABEL:
+    case Instruction::JUMP:
+    case Instruction::JUMPC:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+int irl::dce(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.empty() || instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    size_t before = instructions.size();
+    int bound = id_bound(function);
+    Cfg cfg(function);
+
+    // unreachable blocks go first, along with the phi edges leaving them
+    std::vector<bool> dead_label(bound, false);
+
+    for (int b = 0; b < cfg.size(); b++)
+    {
+        if (cfg.is_reachable(b))
+            continue;
+
+        auto& block = cfg.get_block(b);
+        dead_label[block.label->id] = true;
+
+        for (size_t i = block.begin; i < block.end; i++)
+            instructions[i].reset();
+    }
+
+    std::vector<Phi*> phis;
+
+    for (auto& instruction: instructions)
+    {
+        if (!instruction)
+            continue;
+
+        if (instruction->get_opcode() == Instruction::JUMPC)
+        {
+            auto jump = static_cast<JumpC*>(instruction.get());
+
+            if (jump->get_on_true() == jump->get_on_false())
+                instruction = std::make_unique<Jump>(jump->get_on_true());
+        }
+        else if (instruction->get_opcode() == Instruction::PHI)
+        {
+            auto phi = static_cast<Phi*>(instruction.get());
+            auto& branches = phi->get_branches();
+
+            branches.erase(std::remove_if(branches.begin(), branches.end(), [&](Phi::Node& node) { return dead_label[node.origin->id]; }), branches.end());
+            phis.push_back(phi);
+        }
+    }
+
+    // a phi merging a single value (besides itself) is that value
+    std::vector<std::shared_ptr<Value>> replacement(bound);
+
+    auto resolve = [&](std::shared_ptr<Value> value)
+    {
+        for (int id = id_of(value); id >= 0 && replacement[id]; id = id_of(value))
+            value = replacement[id];
+
+        return value;
+    };
+
+    for (bool changed = true; changed; )
+    {
+        changed = false;
+
+        for (auto phi: phis)
+        {
+            auto out = phi->get_out();
+
+            if (replacement[out->id])
+                continue;
+
+            std::shared_ptr<Value> unique;
+            bool trivial = true;
+
+            for (auto& branch: phi->get_branches())
+            {
+                branch.val = resolve(branch.val);
+
+                if (branch.val == out || branch.val == unique)
+                    continue;
+
+                if (unique)
+                    trivial = false;
+
+                unique = branch.val;
+            }
+
+            if (trivial && unique)
+            {
+                replacement[out->id] = unique;
+                changed = true;
+            }
+        }
+    }
+
+    // mark from the instructions with effects through the operands, then sweep
+    std::vector<int> def_of(bound, -1);
+    std::vector<int> work;
+    std::vector<bool> live(instructions.size(), false);
+
+    for (size_t i = 0; i < instructions.size(); i++)
+    {
+        auto& instruction = instructions[i];
+
+        if (!instruction)
+            continue;
+
+        for (auto operand: instruction->get_operands())
+            *operand = resolve(*operand);
+
+        if (auto out = instruction->get_out(); out && !replacement[out->id])
+            def_of[out->id] = i;
+
+        if (has_effect(*instruction))
+        {
+            live[i] = true;
+            work.push_back(i);
+        }
+    }
+
+    while (!work.empty())
+    {
+        int i = work.back();
+        work.pop_back();
+
+        for (auto operand: instructions[i]->get_operands())
+        {
+            int id = id_of(*operand);
+
+            if (id < 0 || def_of[id] < 0 || live[def_of[id]])
+                continue;
+
+            live[def_of[id]] = true;
+            work.push_back(def_of[id]);
+        }
+    }
+
+    size_t kept = 0;
+
+    for (size_t i = 0; i < instructions.size(); i++)
+    {
+        if (instructions[i] && live[i])
+            instructions[kept++] = std::move(instructions[i]);
+    }
+
+    instructions.resize(kept);
+
+    return before - kept;
+}
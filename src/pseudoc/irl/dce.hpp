@@ -0,0 +1,14 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // removes the blocks unreachable from the entry, folds branches whose
+    // targets are equal and phis whose incoming values are, then sweeps
+    // every instruction whose value is never used by something with an
+    // effect (stores, calls, control flow). the function must be
+    // renumbered before and has to be renumbered again after. returns the
+    // number of removed instructions
+    int dce(IrlSegment& function);
+}
@@ -0,0 +1,263 @@
+#include <pseudoc/irl/dominators.hpp>
+
+using namespace irl;
+
+// compact adjacency arrays of an edge list, by source or by target
+static void adjacency(int nodes, const std::vector<std::pair<int, int>>& edges, bool by_target, std::vector<int>& offsets, std::vector<int>& targets)
+{
+    offsets.assign(nodes + 1, 0);
+
+    for (auto& edge: edges)
+        offsets[(by_target ? edge.second : edge.first) + 1]++;
+
+    for (int v = 0; v < nodes; v++)
+        offsets[v + 1] += offsets[v];
+
+    targets.resize(edges.size());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+
+    for (auto& edge: edges)
+    {
+        if (by_target)
+            targets[fill[edge.second]++] = edge.first;
+        else
+            targets[fill[edge.first]++] = edge.second;
+    }
+}
+
+DominatorTree::DominatorTree(const Cfg& cfg, Direction direction)
+{
+    _build_graph(cfg, direction);
+    _build_idom();
+    _build_children();
+    _build_numbering();
+    _build_frontier();
+}
+
+void DominatorTree::_build_graph(const Cfg& cfg, Direction direction)
+{
+    int n = cfg.size();
+    _root = n;
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(n * 2);
+
+    for (int b = 0; b < n; b++)
+    {
+        for (int s: cfg.get_successors(b))
+            edges.push_back(direction == forward ? std::make_pair(b, s) : std::make_pair(s, b));
+
+        if (direction == backward && cfg.get_successors(b).size() == 0)
+            edges.push_back({ _root, b });
+    }
+
+    if (direction == forward)
+        edges.push_back({ _root, 0 });
+
+    adjacency(n + 1, edges, false, _succ_offsets, _succs);
+    adjacency(n + 1, edges, true, _pred_offsets, _preds);
+}
+
+void DominatorTree::_build_idom()
+{
+    int nodes = _root + 1;
+
+    // depth first numbering of the graph, vertex[i] being the node numbered i
+    std::vector<int> dfnum(nodes, -1);
+    std::vector<int> parent(nodes, -1);
+    std::vector<int> vertex;
+    vertex.reserve(nodes);
+
+    std::vector<std::pair<int, int>> stack;
+
+    dfnum[_root] = 0;
+    vertex.push_back(_root);
+    stack.push_back({ _root, _succ_offsets[_root] });
+
+    while (!stack.empty())
+    {
+        auto& frame = stack.back();
+
+        if (frame.second == _succ_offsets[frame.first + 1])
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        int s = _succs[frame.second++];
+
+        if (dfnum[s] >= 0)
+            continue;
+
+        dfnum[s] = vertex.size();
+        parent[s] = frame.first;
+        vertex.push_back(s);
+        stack.push_back({ s, _succ_offsets[s] });
+    }
+
+    // semidominators as dfs numbers, with the forest of processed nodes kept
+    // in ancestor and label, and nodes waiting on their semidominator kept in
+    // intrusive per node buckets
+    std::vector<int> semi(dfnum);
+    std::vector<int> ancestor(nodes, -1);
+    std::vector<int> label(nodes);
+    std::vector<int> bucket(nodes, -1);
+    std::vector<int> next_in_bucket(nodes, -1);
+    std::vector<int> path;
+
+    for (int v = 0; v < nodes; v++)
+        label[v] = v;
+
+    _idom.assign(nodes, -1);
+
+    // node with the smallest semidominator on the path to the forest root,
+    // compressing the path on the way. iterative so deep chains of blocks
+    // do not overflow the stack
+    auto eval = [&](int v)
+    {
+        if (ancestor[v] < 0)
+            return v;
+
+        for (int x = v; ancestor[ancestor[x]] >= 0; x = ancestor[x])
+            path.push_back(x);
+
+        while (!path.empty())
+        {
+            int x = path.back();
+            path.pop_back();
+
+            int a = ancestor[x];
+
+            if (semi[label[a]] < semi[label[x]])
+                label[x] = label[a];
+
+            ancestor[x] = ancestor[a];
+        }
+
+        return label[v];
+    };
+
+    for (int i = vertex.size() - 1; i > 0; i--)
+    {
+        int w = vertex[i];
+
+        for (int e = _pred_offsets[w]; e < _pred_offsets[w + 1]; e++)
+        {
+            int v = _preds[e];
+
+            if (dfnum[v] < 0)
+                continue;
+
+            int u = eval(v);
+
+            if (semi[u] < semi[w])
+                semi[w] = semi[u];
+        }
+
+        int s = vertex[semi[w]];
+        next_in_bucket[w] = bucket[s];
+        bucket[s] = w;
+
+        int p = parent[w];
+        ancestor[w] = p;
+
+        for (int v = bucket[p]; v >= 0; v = next_in_bucket[v])
+        {
+            int u = eval(v);
+            _idom[v] = semi[u] < semi[v] ? u : p;
+        }
+
+        bucket[p] = -1;
+    }
+
+    for (size_t i = 1; i < vertex.size(); i++)
+    {
+        int w = vertex[i];
+
+        if (_idom[w] != vertex[semi[w]])
+            _idom[w] = _idom[_idom[w]];
+    }
+
+    _idom[_root] = -1;
+}
+
+void DominatorTree::_build_children()
+{
+    int nodes = _root + 1;
+    std::vector<std::pair<int, int>> edges;
+
+    for (int v = 0; v < _root; v++)
+    {
+        if (_idom[v] >= 0)
+            edges.push_back({ _idom[v], v });
+    }
+
+    adjacency(nodes, edges, false, _child_offsets, _children);
+}
+
+void DominatorTree::_build_numbering()
+{
+    int nodes = _root + 1;
+
+    _pre.assign(nodes, -1);
+    _last.assign(nodes, -1);
+    _depth.assign(nodes, 0);
+    _preorder.clear();
+
+    std::vector<std::pair<int, int>> stack;
+    int next = 0;
+
+    _pre[_root] = next++;
+    stack.push_back({ _root, _child_offsets[_root] });
+
+    while (!stack.empty())
+    {
+        auto& frame = stack.back();
+
+        if (frame.second == _child_offsets[frame.first + 1])
+        {
+            _last[frame.first] = next - 1;
+            stack.pop_back();
+            continue;
+        }
+
+        int child = _children[frame.second++];
+
+        _pre[child] = next++;
+        _depth[child] = _depth[frame.first] + 1;
+        _preorder.push_back(child);
+        stack.push_back({ child, _child_offsets[child] });
+    }
+}
+
+void DominatorTree::_build_frontier()
+{
+    int nodes = _root + 1;
+
+    // (block, frontier member) pairs, found by walking up from each
+    // predecessor of a join point until its immediate dominator
+    std::vector<std::pair<int, int>> pairs;
+    std::vector<int> last(nodes, -1);
+
+    for (int b: _preorder)
+    {
+        if (_pred_offsets[b + 1] - _pred_offsets[b] < 2)
+            continue;
+
+        for (int e = _pred_offsets[b]; e < _pred_offsets[b + 1]; e++)
+        {
+            int p = _preds[e];
+
+            if (_pre[p] < 0)
+                continue;
+
+            for (int runner = p; runner != _idom[b] && last[runner] != b; runner = _idom[runner])
+            {
+                last[runner] = b;
+                pairs.push_back({ runner, b });
+            }
+        }
+    }
+
+    adjacency(nodes, pairs, false, _frontier_offsets, _frontier);
+}
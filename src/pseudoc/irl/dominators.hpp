@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+
+#include <pseudoc/irl/cfg.hpp>
+
+namespace irl
+{
+    // dominator tree of a cfg, or post-dominator tree when built backward,
+    // computed with Lengauer-Tarjan (path compression, no balancing) so it
+    // stays near linear on very large functions. a virtual root sits above
+    // the entry, or above every block ending in ret when backward, and is
+    // never visible through the api. blocks the walk cannot reach (dead
+    // code, or infinite loops when backward) have no dominator and neither
+    // dominate nor are dominated by anything. children and frontiers use the
+    // same compact adjacency layout as the cfg, and the tree is numbered in
+    // preorder so dominates() is a constant time interval check
+    class DominatorTree
+    {
+    public:
+        enum Direction
+        {
+            forward,
+            backward
+        };
+
+        DominatorTree(const Cfg& cfg, Direction direction = forward);
+
+        // immediate dominator, -1 for the roots and unreachable blocks
+        int get_idom(int block) const
+        {
+            int idom = _idom[block];
+            return idom == _root ? -1 : idom;
+        }
+
+        // blocks hanging from the virtual root, the entry block when forward
+        BlockRange get_roots() const
+        {
+            return get_children(_root);
+        }
+
+        BlockRange get_children(int block) const
+        {
+            return { _children.data() + _child_offsets[block], _children.data() + _child_offsets[block + 1] };
+        }
+
+        // dominance frontier, the control dependences when backward
+        BlockRange get_frontier(int block) const
+        {
+            return { _frontier.data() + _frontier_offsets[block], _frontier.data() + _frontier_offsets[block + 1] };
+        }
+
+        bool is_reachable(int block) const
+        {
+            return _pre[block] >= 0;
+        }
+
+        // every path from the root to b goes through a, which holds for a == b
+        bool dominates(int a, int b) const
+        {
+            return _pre[a] >= 0 && _pre[b] >= 0 && _pre[a] <= _pre[b] && _last[b] <= _last[a];
+        }
+
+        bool strictly_dominates(int a, int b) const
+        {
+            return a != b && dominates(a, b);
+        }
+
+        // position on the preorder walk of the tree, -1 when unreachable
+        int get_dfs_number(int block) const
+        {
+            return _pre[block] < 0 ? -1 : _pre[block] - 1;
+        }
+
+        // depth in the tree, the roots being at 0
+        int get_depth(int block) const
+        {
+            return _depth[block] - 1;
+        }
+
+        // reachable blocks in preorder of the tree, every block after its dominators
+        const std::vector<int>& get_preorder() const
+        {
+            return _preorder;
+        }
+
+    private:
+        int _root;
+
+        // graph the tree is built over, the cfg plus the virtual root,
+        // reversed when backward
+        std::vector<int> _succ_offsets;
+        std::vector<int> _succs;
+        std::vector<int> _pred_offsets;
+        std::vector<int> _preds;
+
+        std::vector<int> _idom;
+
+        std::vector<int> _child_offsets;
+        std::vector<int> _children;
+        std::vector<int> _frontier_offsets;
+        std::vector<int> _frontier;
+
+        // preorder number and last preorder number of the subtree of each node
+        std::vector<int> _pre;
+        std::vector<int> _last;
+        std::vector<int> _depth;
+        std::vector<int> _preorder;
+
+        void _build_graph(const Cfg& cfg, Direction direction);
+        void _build_idom();
+        void _build_children();
+        void _build_numbering();
+        void _build_frontier();
+    };
+}
@@ -0,0 +1,60 @@
+#include <pseudoc/irl/emitter.hpp>
+
+#include <cerrno>
+#include <stdexcept>
+#include <unistd.h>
+
+#include <pseudoc/irl/value.hpp>
+
+using namespace irl;
+
+Emitter::Emitter(int fd):
+    _fd(fd)
+{
+    _buffer.reserve(1 << 20);
+}
+
+Emitter::~Emitter()
+{
+    try
+    {
+        flush();
+    }
+    catch (const std::exception&)
+    {
+    }
+}
+
+Emitter& Emitter::operator << (long value)
+{
+    char buf[20];
+    _buffer.append(buf, format_int(buf, value));
+
+    return *this;
+}
+
+void Emitter::flush()
+{
+    const char* data = _buffer.data();
+    size_t left = _buffer.size();
+
+    // a single write in practice, the loop only handles short writes
+    while (left > 0)
+    {
+        auto written = ::write(_fd, data, left);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            throw std::runtime_error("could not write the output");
+        }
+
+        data += written;
+        left -= written;
+    }
+
+    // keeps the capacity for the next module
+    _buffer.clear();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace irl
+{
+    // collects the text of a whole module in one reusable buffer, so the
+    // output is written with a single write once everything is printed
+    class Emitter
+    {
+    public:
+        Emitter(int fd);
+        ~Emitter();
+
+        Emitter(Emitter& other) = delete;
+        Emitter& operator = (Emitter& other) = delete;
+
+        Emitter& operator << (std::string_view text)
+        {
+            _buffer.append(text.data(), text.size());
+            return *this;
+        }
+
+        Emitter& operator << (char c)
+        {
+            _buffer.push_back(c);
+            return *this;
+        }
+
+        Emitter& operator << (long value);
+
+        Emitter& operator << (int value)
+        {
+            return *this << static_cast<long>(value);
+        }
+
+        size_t size() const
+        {
+            return _buffer.size();
+        }
+
+        void flush();
+
+    private:
+        int _fd;
+        std::string _buffer;
+    };
+}
@@ -0,0 +1,252 @@
+#include <pseudoc/irl/gvn.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/dominators.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+namespace
+{
+    // operands are compared by identity, literals being interned by the pool
+    struct Key
+    {
+        Instruction::Opcode op;
+        LlvmAtomic tp;
+        int cond;
+        Value* lhs;
+        Value* rhs;
+        long generation;
+
+        bool operator == (const Key& other) const
+        {
+            return op == other.op && tp == other.tp && cond == other.cond
+                && lhs == other.lhs && rhs == other.rhs && generation == other.generation;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator () (const Key& key) const
+        {
+            size_t h = std::hash<Value*>()(key.lhs);
+            h = h * 31 + std::hash<Value*>()(key.rhs);
+            h = h * 31 + std::hash<long>()(key.generation);
+            return h * 31 + ((key.op << 16) ^ (key.tp << 8) ^ key.cond);
+        }
+    };
+
+    int id_of(const std::shared_ptr<Value>& value)
+    {
+        auto var = dynamic_cast<Variable*>(value.get());
+        return var ? var->id : -1;
+    }
+
+    class Numbering
+    {
+    public:
+        Numbering(IrlSegment& function):
+            _instructions(function.instructions),
+            _cfg(function),
+            _dom(_cfg),
+            _replacement(id_bound(function))
+        {
+        }
+
+        int run()
+        {
+            _walk();
+            _rewrite();
+
+            return _eliminated;
+        }
+
+    private:
+        std::vector<std::unique_ptr<Instruction>>& _instructions;
+        Cfg _cfg;
+        DominatorTree _dom;
+
+        std::vector<std::shared_ptr<Value>> _replacement;
+        std::unordered_map<Key, std::shared_ptr<Value>, KeyHash> _table;
+
+        // keys added by the blocks on the current path of the walk
+        std::vector<Key> _scope;
+        long _generations = 0;
+        int _eliminated = 0;
+
+        std::shared_ptr<Value> _resolve(const std::shared_ptr<Value>& value)
+        {
+            int id = id_of(value);
+
+            if (id < 0 || id >= static_cast<int>(_replacement.size()) || !_replacement[id])
+                return value;
+
+            return _replacement[id];
+        }
+
+        // key of a pure instruction, false for anything that cannot be numbered
+        bool _key(Instruction& instruction, long generation, Key& key)
+        {
+            auto op = instruction.get_opcode();
+            auto operands = instruction.get_operands();
+
+            key = { op, LlvmAtomic::error, -1, nullptr, nullptr, 0 };
+
+            switch (op)
+            {
+            case Instruction::ADD:
+            case Instruction::MUL:
+                key.tp = instruction.get_out()->tp;
+                key.lhs = operands[0]->get();
+                key.rhs = operands[1]->get();
+
+                // commutative, so a * b and b * a share a number
+                if (key.rhs < key.lhs)
+                    std::swap(key.lhs, key.rhs);
+
+                return true;
+
+            case Instruction::SUB:
+            case Instruction::SDIV:
+                key.tp = instruction.get_out()->tp;
+                key.lhs = operands[0]->get();
+                key.rhs = operands[1]->get();
+                return true;
+
+            case Instruction::ICMP:
+                key.tp = (*operands[0])->tp;
+                key.cond = static_cast<ICmp&>(instruction).get_cond();
+                key.lhs = operands[0]->get();
+                key.rhs = operands[1]->get();
+
+                if ((key.cond == ICmp::eq || key.cond == ICmp::ne) && key.rhs < key.lhs)
+                    std::swap(key.lhs, key.rhs);
+
+                return true;
+
+            case Instruction::ZEXT:
+                key.tp = instruction.get_out()->tp;
+                key.lhs = operands[0]->get();
+                return true;
+
+            case Instruction::LOAD:
+                key.tp = instruction.get_out()->tp;
+                key.lhs = operands[0]->get();
+                key.generation = generation;
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        void _visit(int b, long& generation)
+        {
+            auto& block = _cfg.get_block(b);
+
+            // memory seen on the dominator may have changed on another path
+            if (_cfg.get_predecessors(b).size() != 1)
+                generation = ++_generations;
+
+            for (size_t i = block.begin + 1; i < block.end; i++)
+            {
+                auto& instruction = _instructions[i];
+
+                for (auto operand: instruction->get_operands())
+                    *operand = _resolve(*operand);
+
+                // allocas never escape, so calls cannot write them
+                if (instruction->get_opcode() == Instruction::STORE)
+                {
+                    generation = ++_generations;
+                    continue;
+                }
+
+                Key key;
+
+                if (!_key(*instruction, generation, key))
+                    continue;
+
+                auto it = _table.find(key);
+
+                if (it == _table.end())
+                {
+                    _table.emplace(key, instruction->get_out());
+                    _scope.push_back(key);
+                    continue;
+                }
+
+                _replacement[instruction->get_out()->id] = it->second;
+                instruction.reset();
+                _eliminated++;
+            }
+        }
+
+        void _walk()
+        {
+            struct Frame
+            {
+                int block;
+                const int* next;
+                size_t scope;
+                long generation;
+            };
+
+            std::vector<Frame> walk;
+
+            auto enter = [&](int b, long generation)
+            {
+                walk.push_back({ b, _dom.get_children(b).begin(), _scope.size(), generation });
+                _visit(b, walk.back().generation);
+            };
+
+            enter(0, 0);
+
+            while (!walk.empty())
+            {
+                auto& frame = walk.back();
+
+                if (frame.next != _dom.get_children(frame.block).end())
+                {
+                    int child = *frame.next++;
+                    enter(child, frame.generation);
+                    continue;
+                }
+
+                while (_scope.size() > frame.scope)
+                {
+                    _table.erase(_scope.back());
+                    _scope.pop_back();
+                }
+
+                walk.pop_back();
+            }
+        }
+
+        // phis and unreachable code may use values eliminated after them
+        void _rewrite()
+        {
+            for (auto& instruction: _instructions)
+            {
+                if (!instruction)
+                    continue;
+
+                for (auto operand: instruction->get_operands())
+                    *operand = _resolve(*operand);
+            }
+
+            _instructions.erase(std::remove(_instructions.begin(), _instructions.end(), nullptr), _instructions.end());
+        }
+    };
+}
+
+int irl::gvn(IrlSegment& function)
+{
+    if (function.instructions.empty() || function.instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    return Numbering(function).run();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // dominator based value numbering: walks the dominator tree with a
+    // scoped table keyed by (opcode, type, condition, operands), so an
+    // arithmetic, comparison, extension or load computing what a
+    // dominating instruction already did is replaced by its value. loads
+    // are also keyed by a memory generation bumped at every store and at
+    // every join point. the function must be renumbered before and has to
+    // be renumbered again after. returns the number of eliminated
+    // instructions
+    int gvn(IrlSegment& function);
+}
@@ -0,0 +1,423 @@
+#include <pseudoc/irl/inliner.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <pseudoc/irl/analyses.hpp>
+#include <pseudoc/irl/optimizer.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+namespace
+{
+    // instructions a callee may have to be inlined outside of loops, each
+    // loop around the call adds as much again, up to max_hot_threshold
+    constexpr int base_threshold = 24;
+    constexpr int max_hot_threshold = 96;
+
+    // a caller grows to at most twice its size, or by growth_slack
+    // instructions when it is small, and never past max_function_size
+    constexpr int growth_slack = 64;
+    constexpr int max_function_size = 4000;
+
+    bool is_definition(IrlSegment& segment)
+    {
+        return !segment.instructions.empty() && segment.instructions.front()->get_opcode() == Instruction::DEF;
+    }
+
+    // instructions left once the function runs, labels and the Def ... EndDef frame do not count
+    int cost_of(IrlSegment& function)
+    {
+        int cost = 0;
+
+        for (auto& instruction: function.instructions)
+        {
+            switch (instruction->get_opcode())
+            {
+            case Instruction::DEF:
+            case Instruction::END_DEF:
+            case Instruction::LABEL:
+                break;
+
+            default:
+                cost++;
+            }
+        }
+
+        return cost;
+    }
+
+    bool has_ret(IrlSegment& function)
+    {
+        return std::any_of(function.instructions.begin(), function.instructions.end(), [](auto& instruction)
+        {
+            return instruction->get_opcode() == Instruction::RET;
+        });
+    }
+
+    // functions of the module and the calls between them, with the strongly
+    // connected components (Tarjan) listed callees first
+    class CallGraph
+    {
+    public:
+        CallGraph(std::vector<std::unique_ptr<IrlSegment>>& module, const FunctionTable& ftable)
+        {
+            for (auto& segment: module)
+            {
+                if (!is_definition(*segment))
+                    continue;
+
+                auto def = static_cast<Def*>(segment->instructions.front().get());
+                _index_of[def->get_id()] = _functions.size();
+                _functions.push_back(segment.get());
+            }
+
+            _callees.resize(_functions.size());
+
+            for (size_t f = 0; f < _functions.size(); f++)
+            {
+                for (auto& instruction: _functions[f]->instructions)
+                {
+                    if (instruction->get_opcode() != Instruction::CALL)
+                        continue;
+
+                    auto& id = static_cast<Call*>(instruction.get())->get_id();
+                    int callee = get_index(id);
+
+                    if (callee >= 0 && ftable.is_defined(id))
+                        _callees[f].push_back(callee);
+                }
+            }
+
+            _component.assign(_functions.size(), -1);
+            _low.assign(_functions.size(), -1);
+            _order.assign(_functions.size(), -1);
+
+            for (size_t f = 0; f < _functions.size(); f++)
+            {
+                if (_order[f] < 0)
+                    _visit(f);
+            }
+        }
+
+        int size() const
+        {
+            return _functions.size();
+        }
+
+        IrlSegment& get_function(int function) const
+        {
+            return *_functions[function];
+        }
+
+        // -1 for functions defined outside the module
+        int get_index(const std::string& id) const
+        {
+            auto it = _index_of.find(id);
+            return it == _index_of.end() ? -1 : it->second;
+        }
+
+        int get_component(int function) const
+        {
+            return _component[function];
+        }
+
+        // functions in the order their components were closed, callees before callers
+        const std::vector<int>& get_bottom_up() const
+        {
+            return _bottom_up;
+        }
+
+    private:
+        std::vector<IrlSegment*> _functions;
+        std::unordered_map<std::string, int> _index_of;
+        std::vector<std::vector<int>> _callees;
+
+        std::vector<int> _component;
+        std::vector<int> _low;
+        std::vector<int> _order;
+        std::vector<int> _stack;
+        std::vector<int> _bottom_up;
+        int _next_order = 0;
+        int _components = 0;
+
+        void _visit(int f)
+        {
+            _order[f] = _low[f] = _next_order++;
+            _stack.push_back(f);
+
+            for (int callee: _callees[f])
+            {
+                if (_order[callee] < 0)
+                {
+                    _visit(callee);
+                    _low[f] = std::min(_low[f], _low[callee]);
+                }
+                else if (_component[callee] < 0)
+                {
+                    _low[f] = std::min(_low[f], _order[callee]);
+                }
+            }
+
+            if (_low[f] != _order[f])
+                return;
+
+            int member;
+
+            do
+            {
+                member = _stack.back();
+                _stack.pop_back();
+
+                _component[member] = _components;
+                _bottom_up.push_back(member);
+            }
+            while (member != f);
+
+            _components++;
+        }
+    };
+
+    class Inliner
+    {
+    public:
+        Inliner(const CallGraph& graph, int caller):
+            _graph(graph),
+            _caller(caller),
+            _function(graph.get_function(caller))
+        {
+        }
+
+        // number of inlined calls
+        int run()
+        {
+            int size = cost_of(_function);
+            int budget = std::min(std::max(2 * size, size + growth_slack), max_function_size) - size;
+
+            // loop depth of every call, before the code moves
+            Analyses analyses(_function);
+            auto& cfg = analyses.get_cfg();
+            auto& loops = analyses.get_loops();
+            std::vector<int> depth_at(_function.instructions.size(), 0);
+
+            for (int b = 0; b < cfg.size(); b++)
+            {
+                auto& block = cfg.get_block(b);
+                std::fill(depth_at.begin() + block.begin, depth_at.begin() + block.end, loops.get_depth(b));
+            }
+
+            auto instructions = std::move(_function.instructions);
+            _function.instructions.clear();
+
+            size_t entry_end = 0;
+            int inlined = 0;
+            std::shared_ptr<Variable> block_label;
+
+            for (size_t i = 0; i < instructions.size(); i++)
+            {
+                auto& instruction = instructions[i];
+
+                if (instruction->get_opcode() == Instruction::LABEL)
+                {
+                    block_label = *instruction->get_out_slot();
+
+                    // allocas of the callees go to the caller entry, to run once
+                    if (entry_end == 0)
+                        entry_end = _function.instructions.size() + 1;
+                }
+
+                if (instruction->get_opcode() == Instruction::CALL)
+                {
+                    auto call = static_cast<Call*>(instruction.get());
+                    int callee = _graph.get_index(call->get_id());
+
+                    if (callee >= 0 && _should_inline(*call, callee, depth_at[i], budget))
+                    {
+                        budget -= cost_of(_graph.get_function(callee));
+                        _exit_of[block_label.get()] = _inline(*call, _graph.get_function(callee));
+                        inlined++;
+                        continue;
+                    }
+                }
+
+                _function.instructions.push_back(std::move(instruction));
+            }
+
+            if (inlined == 0)
+                return 0;
+
+            // edges leaving a block that got a call inlined now leave from its last part
+            for (auto& instruction: _function.instructions)
+            {
+                if (instruction->get_opcode() != Instruction::PHI)
+                    continue;
+
+                for (auto& branch: static_cast<Phi*>(instruction.get())->get_branches())
+                {
+                    auto it = _exit_of.find(branch.origin.get());
+
+                    if (it != _exit_of.end())
+                        branch.origin = it->second;
+                }
+            }
+
+            auto& body = _function.instructions;
+            body.insert(body.begin() + entry_end, std::make_move_iterator(_allocas.begin()), std::make_move_iterator(_allocas.end()));
+
+            return inlined;
+        }
+
+    private:
+        const CallGraph& _graph;
+        int _caller;
+        IrlSegment& _function;
+
+        // last label of each block of the caller that had calls inlined
+        std::unordered_map<Variable*, std::shared_ptr<Variable>> _exit_of;
+        std::vector<std::unique_ptr<Instruction>> _allocas;
+
+        bool _should_inline(Call& call, int callee, int depth, int budget)
+        {
+            auto& function = _graph.get_function(callee);
+            auto def = static_cast<Def*>(function.instructions.front().get());
+
+            if (_graph.get_component(callee) == _graph.get_component(_caller))
+                return false;
+
+            if (def->get_params().size() != call.get_operands().size() || !has_ret(function))
+                return false;
+
+            int cost = cost_of(function);
+
+            // no bigger than the call sequence it replaces
+            if (cost <= static_cast<int>(def->get_params().size()) + 2)
+                return true;
+
+            int threshold = std::min(base_threshold * (1 + depth), max_hot_threshold);
+            return cost <= threshold && cost <= budget;
+        }
+
+        // returns the label of the code after the call
+        std::shared_ptr<Variable> _inline(Call& call, IrlSegment& callee)
+        {
+            auto& instructions = callee.instructions;
+            auto def = static_cast<Def*>(instructions.front().get());
+
+            // every id of the callee renamed, the parameters to the arguments
+            std::vector<std::shared_ptr<Value>> renamed(id_bound(callee));
+            auto operands = call.get_operands();
+
+            for (size_t p = 0; p < operands.size(); p++)
+                renamed[def->get_params()[p]->id] = *operands[p];
+
+            for (auto& instruction: instructions)
+            {
+                if (auto slot = instruction->get_out_slot())
+                {
+                    auto var = std::make_shared<Variable>();
+                    var->tp = (*slot)->tp;
+                    renamed[(*slot)->id] = var;
+                }
+            }
+
+            auto rename = [&](const std::shared_ptr<Variable>& var)
+            {
+                return std::static_pointer_cast<Variable>(renamed[var->id]);
+            };
+
+            auto after = std::make_shared<Variable>();
+            after->tp = LlvmAtomic::v;
+
+            auto out = call.get_out();
+            auto merge = out ? std::make_unique<Phi>(out, out->tp) : nullptr;
+            std::shared_ptr<Variable> block_label;
+
+            for (auto& instruction: instructions)
+            {
+                auto op = instruction->get_opcode();
+
+                if (op == Instruction::DEF || op == Instruction::END_DEF)
+                    continue;
+
+                if (op == Instruction::RET)
+                {
+                    auto ret_operands = instruction->get_operands();
+
+                    if (merge && !ret_operands.empty())
+                    {
+                        auto value = *ret_operands[0];
+
+                        if (auto var = dynamic_cast<Variable*>(value.get()))
+                            value = renamed[var->id];
+
+                        merge->add_branch(value, block_label);
+                    }
+
+                    _function.instructions.push_back(std::make_unique<Jump>(after));
+                    continue;
+                }
+
+                auto copy = instruction->clone();
+
+                if (op == Instruction::LABEL)
+                {
+                    block_label = rename(*copy->get_out_slot());
+
+                    // the callee entry is reached by falling from the call
+                    if (instruction.get() == instructions[1].get())
+                        _function.instructions.push_back(std::make_unique<Jump>(block_label));
+                }
+
+                if (auto slot = copy->get_out_slot())
+                    *slot = rename(*slot);
+
+                for (auto operand: copy->get_operands())
+                {
+                    if (auto var = dynamic_cast<Variable*>(operand->get()))
+                        *operand = renamed[var->id];
+                }
+
+                for (auto target: copy->get_targets())
+                    *target = rename(*target);
+
+                if (op == Instruction::PHI)
+                {
+                    for (auto& branch: static_cast<Phi*>(copy.get())->get_branches())
+                        branch.origin = rename(branch.origin);
+                }
+
+                if (op == Instruction::ALLOCA)
+                    _allocas.push_back(std::move(copy));
+                else
+                    _function.instructions.push_back(std::move(copy));
+            }
+
+            _function.instructions.push_back(std::make_unique<Label>(after));
+
+            if (merge)
+                _function.instructions.push_back(std::move(merge));
+
+            return after;
+        }
+    };
+}
+
+void irl::inline_functions(std::vector<std::unique_ptr<IrlSegment>>& module, const FunctionTable& ftable,
+    ConstantPool& constants, int level, Statistics& stats)
+{
+    CallGraph graph(module, ftable);
+
+    for (int f: graph.get_bottom_up())
+    {
+        auto& function = graph.get_function(f);
+        int inlined = Inliner(graph, f).run();
+
+        if (inlined == 0)
+            continue;
+
+        stats.add("inline - calls inlined", inlined);
+        renumber(function);
+        optimize(function, constants, level, stats);
+    }
+}
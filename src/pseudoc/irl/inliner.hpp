@@ -0,0 +1,25 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <pseudoc/irl/constant-pool.hpp>
+#include <pseudoc/irl/segment.hpp>
+#include <pseudoc/irl/statistics.hpp>
+#include <pseudoc/variable-map.hpp>
+
+namespace irl
+{
+    // replaces calls to small functions defined in the module by a copy of
+    // their body: temporaries and labels are renamed, the parameters read
+    // the arguments, every ret jumps to the code after the call and a phi
+    // merges the returned values. functions are visited bottom-up on the
+    // call graph (callees first, the functions of a cycle together), so the
+    // copied bodies were already inlined into and optimized, and calls
+    // inside a cycle are never inlined. a call is inlined when the callee
+    // is cheap for how hot the call is (its loop depth), as long as the
+    // caller stays under its growth limit. callers that received code are
+    // optimized again at the level. the functions must be renumbered
+    void inline_functions(std::vector<std::unique_ptr<IrlSegment>>& module, const FunctionTable& ftable,
+        ConstantPool& constants, int level, Statistics& stats);
+}
@@ -2,20 +2,28 @@
 
 using namespace irl;
 
+bool Instruction::is_terminator()
+{
+    auto op = get_opcode();
+    return op == Opcode::RET || op == Opcode::JUMP || op == Opcode::JUMPC;
+}
+
 Alloca::Alloca(std::shared_ptr<Variable> out_var, short alignment):
     _out_var(std::move(out_var)),
     _alignment(alignment)
 {
 }
 
-std::string Alloca::print()
+std::shared_ptr<Variable> Alloca::get_out()
+{
+    return _out_var;
+}
+
+void Alloca::emit(Emitter& out)
 {
-    return "  " + _out_var->print()
-        + " = alloca "
-        + atomic_to_string(_out_var->tp)
-        + ", align "
-        + std::to_string(_alignment)
-        + "\n";
+    out << "  ";
+    _out_var->emit(out);
+    out << " = alloca " << atomic_to_string(_out_var->tp) << ", align " << _alignment << '\n';
 }
 
 Store::Store(std::shared_ptr<Value> from, std::shared_ptr<Value> to, short alignment):
@@ -25,36 +33,49 @@ Store::Store(std::shared_ptr<Value> from, std::shared_ptr<Value> to, short align
 {
 }
 
-std::string Store::print()
+std::shared_ptr<Value> Store::get_from()
 {
-    std::string res = "  store ";
-    return res
-        + atomic_to_string(_from->tp)
-        + " " + _from->print()
-        + ", " + atomic_to_string(_from->tp)
-        + "* " + _to->print()
-        + ", align " + std::to_string(_alignment)
-        + "\n";
+    return _from;
 }
 
-Load::Load(std::shared_ptr<Variable> from, std::shared_ptr<Variable> to, short alignment):
+std::shared_ptr<Value> Store::get_to()
+{
+    return _to;
+}
+
+void Store::emit(Emitter& out)
+{
+    out << "  store " << atomic_to_string(_from->tp) << ' ';
+    _from->emit(out);
+    out << ", " << atomic_to_string(_from->tp) << "* ";
+    _to->emit(out);
+    out << ", align " << _alignment << '\n';
+}
+
+Load::Load(std::shared_ptr<Value> from, std::shared_ptr<Variable> to, short alignment):
     _from(std::move(from)),
     _to(std::move(to)),
     _alignment(alignment)
 {
 }
 
-std::string Load::print()
+std::shared_ptr<Variable> Load::get_out()
+{
+    return _to;
+}
+
+std::shared_ptr<Value> Load::get_from()
 {
-    return "  " + _to->print()
-        + " = load "
-        + atomic_to_string(_to->tp)
-        + ", "
-        + atomic_to_string(_from->tp)
-        + "* " + _from->print()
-        + ", align "
-        + std::to_string(_alignment)
-        + "\n";
+    return _from;
+}
+
+void Load::emit(Emitter& out)
+{
+    out << "  ";
+    _to->emit(out);
+    out << " = load " << atomic_to_string(_to->tp) << ", " << atomic_to_string(_from->tp) << "* ";
+    _from->emit(out);
+    out << ", align " << _alignment << '\n';
 }
 
 Add::Add(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp):
@@ -68,14 +89,20 @@ Add::Add(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_
         throw std::logic_error("Type mismatch");
 }
 
-std::string Add::print()
+std::shared_ptr<Variable> Add::get_out()
 {
-    return "  " + _out->print()
-        + " = add nsw "
-        + atomic_to_string(_tp)
-        + " " + _lhs->print()
-        + ", " + _rhs->print()
-        + "\n";
+    return _out;
+}
+
+void Add::emit(Emitter& out)
+{
+    out << "  ";
+    _out->emit(out);
+    out << " = add nsw " << atomic_to_string(_tp) << ' ';
+    _lhs->emit(out);
+    out << ", ";
+    _rhs->emit(out);
+    out << '\n';
 }
 
 Sub::Sub(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp):
@@ -89,14 +116,20 @@ Sub::Sub(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_
         throw std::logic_error("Type mismatch");
 }
 
-std::string Sub::print()
+std::shared_ptr<Variable> Sub::get_out()
+{
+    return _out;
+}
+
+void Sub::emit(Emitter& out)
 {
-    return "  " + _out->print()
-        + " = sub nsw "
-        + atomic_to_string(_tp)
-        + " " + _lhs->print()
-        + ", " + _rhs->print()
-        + "\n";
+    out << "  ";
+    _out->emit(out);
+    out << " = sub nsw " << atomic_to_string(_tp) << ' ';
+    _lhs->emit(out);
+    out << ", ";
+    _rhs->emit(out);
+    out << '\n';
 }
 
 Mul::Mul(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp):
@@ -110,14 +143,20 @@ Mul::Mul(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_
         throw std::logic_error("Type mismatch");
 }
 
-std::string Mul::print()
+std::shared_ptr<Variable> Mul::get_out()
 {
-    return "  " + _out->print()
-        + " = mul nsw "
-        + atomic_to_string(_tp)
-        + " " + _lhs->print()
-        + ", " + _rhs->print()
-        + "\n";
+    return _out;
+}
+
+void Mul::emit(Emitter& out)
+{
+    out << "  ";
+    _out->emit(out);
+    out << " = mul nsw " << atomic_to_string(_tp) << ' ';
+    _lhs->emit(out);
+    out << ", ";
+    _rhs->emit(out);
+    out << '\n';
 }
 
 SDiv::SDiv(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp):
@@ -131,41 +170,78 @@ SDiv::SDiv(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::share
         throw std::logic_error("Type mismatch");
 }
 
-std::string SDiv::print()
+std::shared_ptr<Variable> SDiv::get_out()
 {
-    return "  " + _out->print()
-        + " = sdiv nsw "
-        + atomic_to_string(_tp)
-        + " " + _lhs->print()
-        + ", " + _rhs->print()
-        + "\n";
+    return _out;
 }
 
-Def::Def(std::string id, const FunctionDef& def):
+void SDiv::emit(Emitter& out)
+{
+    out << "  ";
+    _out->emit(out);
+    out << " = sdiv " << atomic_to_string(_tp) << ' ';
+    _lhs->emit(out);
+    out << ", ";
+    _rhs->emit(out);
+    out << '\n';
+}
+
+Def::Def(std::string id, const FunctionDef& def, std::vector<std::shared_ptr<Variable>> params):
     _id(std::move(id)),
-    _def(def)
+    _def(def),
+    _params(std::move(params))
+{
+}
+
+const std::string& Def::get_id()
+{
+    return _id;
+}
+
+const std::vector<std::shared_ptr<Variable>>& Def::get_params()
 {
+    return _params;
 }
 
-std::string Def::print()
+void Def::emit(Emitter& out)
 {
-    std::string params = "(";
-    std::string junc = "";
+    out << "define " << atomic_to_string(_def.tp) << " @" << _id << '(';
 
-    for (auto& tp: _def.params)
+    for (size_t i = 0; i < _def.params.size(); i++)
     {
-        params += junc + atomic_to_string(tp);
-        junc = ", ";
+        if (i > 0)
+            out << ", ";
+
+        out << atomic_to_string(_def.params[i]);
     }
 
-    params += ")";
+    out << ") #0 {\n";
+}
+
+Declare::Declare(std::string id, const FunctionDef& def):
+    _id(std::move(id)),
+    _def(def)
+{
+}
+
+void Declare::emit(Emitter& out)
+{
+    out << "declare " << atomic_to_string(_def.tp) << " @" << _id << '(';
+
+    for (size_t i = 0; i < _def.params.size(); i++)
+    {
+        if (i > 0)
+            out << ", ";
+
+        out << atomic_to_string(_def.params[i]);
+    }
 
-    return "define " + atomic_to_string(_def.tp) + " @" + _id + params + " #0 {\n";
+    out << ")\n";
 }
 
-std::string EndDef::print()
+void EndDef::emit(Emitter& out)
 {
-    return "}\n";
+    out << "}\n";
 }
 
 Ret::Ret(std::shared_ptr<Value> res, LlvmAtomic tp):
@@ -174,9 +250,17 @@ Ret::Ret(std::shared_ptr<Value> res, LlvmAtomic tp):
     _tp = tp;
 }
 
-std::string Ret::print()
+void Ret::emit(Emitter& out)
 {
-    return "  ret " + atomic_to_string(_tp) + " " + _res->print() + "\n";
+    out << "  ret " << atomic_to_string(_tp);
+
+    if (_tp != LlvmAtomic::v)
+    {
+        out << ' ';
+        _res->emit(out);
+    }
+
+    out << '\n';
 }
 
 Label::Label(std::shared_ptr<Variable> ref):
@@ -184,9 +268,11 @@ Label::Label(std::shared_ptr<Variable> ref):
 {
 }
 
-std::string Label::print()
+void Label::emit(Emitter& out)
 {
-    return "\n; <label>:" + _ref->print() + ":\n";
+    out << "\n; <label>:";
+    _ref->emit(out);
+    out << ":\n";
 }
 
 std::shared_ptr<Variable> Label::get_ref()
@@ -199,9 +285,16 @@ Jump::Jump(std::shared_ptr<Variable> label_ref):
 {
 }
 
-std::string Jump::print()
+std::shared_ptr<Variable> Jump::get_target()
+{
+    return _label_ref;
+}
+
+void Jump::emit(Emitter& out)
 {
-    return "  br label " + _label_ref->print() + "\n";
+    out << "  br label ";
+    _label_ref->emit(out);
+    out << '\n';
 }
 
 JumpC::JumpC(std::shared_ptr<Value> condition, std::shared_ptr<Variable> on_true, std::shared_ptr<Variable> on_false):
@@ -211,9 +304,30 @@ JumpC::JumpC(std::shared_ptr<Value> condition, std::shared_ptr<Variable> on_true
 {
 }
 
-std::string JumpC::print()
+std::shared_ptr<Value> JumpC::get_condition()
 {
-    return "  br i1 " + _condition->print() + ", label " + _on_true->print() + ", label " + _on_false->print() + "\n";
+    return _condition;
+}
+
+std::shared_ptr<Variable> JumpC::get_on_true()
+{
+    return _on_true;
+}
+
+std::shared_ptr<Variable> JumpC::get_on_false()
+{
+    return _on_false;
+}
+
+void JumpC::emit(Emitter& out)
+{
+    out << "  br i1 ";
+    _condition->emit(out);
+    out << ", label ";
+    _on_true->emit(out);
+    out << ", label ";
+    _on_false->emit(out);
+    out << '\n';
 }
 
 ICmp::ICmp(ICmp::CondT cond, std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp):
@@ -223,59 +337,32 @@ ICmp::ICmp(ICmp::CondT cond, std::shared_ptr<Variable> out, std::shared_ptr<Valu
 {
     _rhs = rhs;
     _tp = tp;
+
+    if (_out->tp != LlvmAtomic::b || _lhs->tp != tp || _rhs->tp != tp)
+        throw std::logic_error("Type mismatch");
 }
 
-std::string ICmp::print()
+ICmp::CondT ICmp::get_cond()
 {
-    std::string t;
-
-    switch (_cond)
-    {
-    case CondT::eq:
-        t = "eq";
-        break;
-
-    case CondT::ne:
-        t = "ne";
-        break;
-
-    case CondT::ugt:
-        t = "ugt";
-        break;
-
-    case CondT::uge:
-        t = "uge";
-        break;
-
-    case CondT::ult:
-        t = "ult";
-        break;
-
-    case CondT::ule:
-        t = "ule";
-        break;
-
-    case CondT::sgt:
-        t = "sgt";
-        break;
-
-    case CondT::sge:
-        t = "sge";
-        break;
+    return _cond;
+}
 
-    case CondT::slt:
-        t = "slt";
-        break;
+std::shared_ptr<Variable> ICmp::get_out()
+{
+    return _out;
+}
 
-    case CondT::sle:
-        t = "sle";
-        break;
-    }
+void ICmp::emit(Emitter& out)
+{
+    static const char* conds[] = { "eq", "ne", "ugt", "uge", "ult", "ule", "sgt", "sge", "slt", "sle" };
 
-    return "  " + _out->print() + " = icmp " + t + " "
-        + atomic_to_string(_tp) + " "
-        + _lhs->print() + ", "
-        + _rhs->print() + "\n";
+    out << "  ";
+    _out->emit(out);
+    out << " = icmp " << conds[_cond] << ' ' << atomic_to_string(_tp) << ' ';
+    _lhs->emit(out);
+    out << ", ";
+    _rhs->emit(out);
+    out << '\n';
 }
 
 Phi::Phi(std::shared_ptr<Variable> out, LlvmAtomic tp):
@@ -295,22 +382,46 @@ void Phi::add_branch(std::shared_ptr<Value> val, std::shared_ptr<Variable> origi
     });
 }
 
-std::string Phi::print()
+std::vector<Phi::Node>& Phi::get_branches()
+{
+    return _branches;
+}
+
+std::shared_ptr<Variable> Phi::get_out()
+{
+    return _out;
+}
+
+std::vector<std::shared_ptr<Value>*> Phi::get_operands()
+{
+    std::vector<std::shared_ptr<Value>*> operands;
+    operands.reserve(_branches.size());
+
+    for (auto& branch: _branches)
+        operands.push_back(&branch.val);
+
+    return operands;
+}
+
+void Phi::emit(Emitter& out)
 {
     if (_branches.size() < 2)
         throw std::logic_error("Phi command used with less than two operrands");
 
-    std::string res = _out->print() + " = phi " + atomic_to_string(_tp);
-    std::string junc = "";
+    out << "  ";
+    _out->emit(out);
+    out << " = phi " << atomic_to_string(_tp);
 
-    for (const auto& branch: _branches)
+    for (size_t i = 0; i < _branches.size(); i++)
     {
-        res += junc + " [ " + branch.val->print() + ", " + branch.origin->print() + " ]";
-        junc = ",";
+        out << (i > 0 ? ", [ " : " [ ");
+        _branches[i].val->emit(out);
+        out << ", ";
+        _branches[i].origin->emit(out);
+        out << " ]";
     }
 
-    res += '\n';
-    return res;
+    out << '\n';
 }
 
 ZExt::ZExt(std::shared_ptr<Value> in, LlvmAtomic tp1, std::shared_ptr<Variable> out, LlvmAtomic tp2):
@@ -319,13 +430,19 @@ ZExt::ZExt(std::shared_ptr<Value> in, LlvmAtomic tp1, std::shared_ptr<Variable>
 {
 }
 
-std::string ZExt::print()
+std::shared_ptr<Variable> ZExt::get_out()
+{
+    return _out;
+}
+
+void ZExt::emit(Emitter& out)
 {
     // %31 = zext i1 %30 to i32
-    return _out->print() + " = "
-        + atomic_to_string(_in->tp) + " "
-        + _in->print() + " to "
-        + atomic_to_string(_out->tp) + "\n";
+    out << "  ";
+    _out->emit(out);
+    out << " = zext " << atomic_to_string(_in->tp) << ' ';
+    _in->emit(out);
+    out << " to " << atomic_to_string(_out->tp) << '\n';
 }
 
 Call::Call(std::string id, std::shared_ptr<Variable> out, LlvmAtomic tp):
@@ -340,18 +457,49 @@ void Call::add_param(std::shared_ptr<Value> param)
     _params.push_back(std::move(param));
 }
 
-std::string Call::print()
+const std::string& Call::get_id()
 {
-    // %5 = call i32 @func(i32 1, i32 %4, i32 3)
-    std::string l = _tp == LlvmAtomic::v ? "  " : "  " + _out->print() + " = ";
-    l += "call " + atomic_to_string(_tp) + " @" + _id + "(";
-    std::string junc = "";
+    return _id;
+}
+
+std::shared_ptr<Variable> Call::get_out()
+{
+    // void calls define nothing
+    return _tp == LlvmAtomic::v ? nullptr : _out;
+}
+
+std::vector<std::shared_ptr<Value>*> Call::get_operands()
+{
+    std::vector<std::shared_ptr<Value>*> operands;
+    operands.reserve(_params.size());
 
     for (auto& param: _params)
+        operands.push_back(&param);
+
+    return operands;
+}
+
+void Call::emit(Emitter& out)
+{
+    // %5 = call i32 @func(i32 1, i32 %4, i32 3)
+    out << "  ";
+
+    if (_tp != LlvmAtomic::v)
     {
-        l += junc + atomic_to_string(param->tp) + " " + param->print();
-        junc = ", ";
+        _out->emit(out);
+        out << " = ";
+    }
+
+    out << "call " << atomic_to_string(_tp) << " @" << _id << '(';
+
+    for (size_t i = 0; i < _params.size(); i++)
+    {
+        if (i > 0)
+            out << ", ";
+
+        out << atomic_to_string(_params[i]->tp) << ' ';
+        _params[i]->emit(out);
     }
 
-    return l + ")\n";
+    out << ")\n";
 }
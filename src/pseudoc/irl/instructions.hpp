@@ -2,7 +2,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <pseudoc/irl/emitter.hpp>
 #include <pseudoc/irl/type.hpp>
 #include <pseudoc/irl/value.hpp>
 
@@ -11,9 +13,63 @@ namespace irl
     class Instruction
     {
     public:
+        enum Opcode
+        {
+            ALLOCA,
+            STORE,
+            LOAD,
+            ADD,
+            SUB,
+            MUL,
+            SDIV,
+            DEF,
+            DECLARE,
+            END_DEF,
+            RET,
+            LABEL,
+            JUMP,
+            JUMPC,
+            ICMP,
+            PHI,
+            ZEXT,
+            CALL
+        };
+
         virtual ~Instruction() = default;
 
-        virtual std::string print() = 0;
+        virtual Opcode get_opcode() = 0;
+        virtual void emit(Emitter& out) = 0;
+
+        // value defined by the instruction, if any
+        virtual std::shared_ptr<Variable> get_out()
+        {
+            return nullptr;
+        }
+
+        // slots of the values read by the instruction, passes rewrite uses through them
+        virtual std::vector<std::shared_ptr<Value>*> get_operands()
+        {
+            return {};
+        }
+
+        // copy reading and defining the same values, passes duplicating code
+        // give the copy its own through the slots
+        virtual std::unique_ptr<Instruction> clone() = 0;
+
+        // slot of the value defined by the instruction, or of the label a
+        // Label starts, null when there is none
+        virtual std::shared_ptr<Variable>* get_out_slot()
+        {
+            return nullptr;
+        }
+
+        // slots of the labels the instruction jumps to, so passes can redirect edges
+        virtual std::vector<std::shared_ptr<Variable>*> get_targets()
+        {
+            return {};
+        }
+
+        bool is_terminator();
     };
 
     class Alloca : public Instruction
@@ -21,10 +77,27 @@ namespace irl
     public:
         Alloca(std::shared_ptr<Variable> out_var, short alignment);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::ALLOCA;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Alloca>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out_var;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        void emit(Emitter& out) override;
 
     private:
-        std::shared_ptr<Value> _out_var;
+        std::shared_ptr<Variable> _out_var;
         short _alignment;
     };
 
@@ -33,7 +106,25 @@ namespace irl
     public:
         Store(std::shared_ptr<Value> from, std::shared_ptr<Value> to, short alignment);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::STORE;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Store>(*this);
+        }
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_from, &_to };
+        }
+
+        void emit(Emitter& out) override;
+
+        std::shared_ptr<Value> get_from();
+        std::shared_ptr<Value> get_to();
 
     private:
         std::shared_ptr<Value> _from;
@@ -44,13 +135,37 @@ namespace irl
     class Load : public Instruction
     {
     public:
-        Load(std::shared_ptr<Variable> from, std::shared_ptr<Variable> to, short alignment);
+        Load(std::shared_ptr<Value> from, std::shared_ptr<Variable> to, short alignment);
+
+        Opcode get_opcode() override
+        {
+            return Opcode::LOAD;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Load>(*this);
+        }
 
-        std::string print() override;
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_to;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_from };
+        }
+
+        void emit(Emitter& out) override;
+
+        std::shared_ptr<Value> get_from();
 
     private:
         std::shared_ptr<Value> _from;
-        std::shared_ptr<Value> _to;
+        std::shared_ptr<Variable> _to;
         short _alignment;
     };
 
@@ -59,7 +174,29 @@ namespace irl
     public:
         Add(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::ADD;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Add>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_lhs, &_rhs };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Variable> _out;
@@ -73,7 +210,29 @@ namespace irl
     public:
         Sub(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::SUB;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Sub>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_lhs, &_rhs };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Variable> _out;
@@ -87,7 +246,29 @@ namespace irl
     public:
         Mul(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::MUL;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Mul>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_lhs, &_rhs };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Variable> _out;
@@ -101,7 +282,29 @@ namespace irl
     public:
         SDiv(std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::SDIV;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<SDiv>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_lhs, &_rhs };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Variable> _out;
@@ -113,9 +316,45 @@ namespace irl
     class Def : public Instruction
     {
     public:
-        Def(std::string id, const FunctionDef& def);
+        Def(std::string id, const FunctionDef& def, std::vector<std::shared_ptr<Variable>> params);
+
+        Opcode get_opcode() override
+        {
+            return Opcode::DEF;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Def>(*this);
+        }
+
+        void emit(Emitter& out) override;
+
+        const std::string& get_id();
+        const std::vector<std::shared_ptr<Variable>>& get_params();
+
+    private:
+        std::string _id;
+        FunctionDef _def;
+        std::vector<std::shared_ptr<Variable>> _params;
+    };
+
+    class Declare : public Instruction
+    {
+    public:
+        Declare(std::string id, const FunctionDef& def);
+
+        Opcode get_opcode() override
+        {
+            return Opcode::DECLARE;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Declare>(*this);
+        }
 
-        std::string print() override;
+        void emit(Emitter& out) override;
 
     private:
         std::string _id;
@@ -125,7 +364,17 @@ namespace irl
     class EndDef : public Instruction
     {
     public:
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::END_DEF;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<EndDef>(*this);
+        }
+
+        void emit(Emitter& out) override;
     };
 
     class Ret : public Instruction
@@ -133,7 +382,25 @@ namespace irl
     public:
         Ret(std::shared_ptr<Value> res, LlvmAtomic tp);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::RET;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Ret>(*this);
+        }
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            if (!_res)
+                return {};
+
+            return { &_res };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Value> _res;
@@ -145,7 +412,22 @@ namespace irl
     public:
         Label(std::shared_ptr<Variable> ref);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::LABEL;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Label>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_ref;
+        }
+
+        void emit(Emitter& out) override;
 
         std::shared_ptr<Variable> get_ref();
 
@@ -158,7 +440,24 @@ namespace irl
     public:
         Jump(std::shared_ptr<Variable> label_ref);
 
-        std::string print() override;
+        std::shared_ptr<Variable> get_target();
+
+        Opcode get_opcode() override
+        {
+            return Opcode::JUMP;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Jump>(*this);
+        }
+
+        std::vector<std::shared_ptr<Variable>*> get_targets() override
+        {
+            return { &_label_ref };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Variable> _label_ref;
@@ -169,7 +468,31 @@ namespace irl
     public:
         JumpC(std::shared_ptr<Value> condition, std::shared_ptr<Variable> on_true, std::shared_ptr<Variable> on_false);
 
-        std::string print() override;
+        std::shared_ptr<Value> get_condition();
+        std::shared_ptr<Variable> get_on_true();
+        std::shared_ptr<Variable> get_on_false();
+
+        Opcode get_opcode() override
+        {
+            return Opcode::JUMPC;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<JumpC>(*this);
+        }
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_condition };
+        }
+
+        std::vector<std::shared_ptr<Variable>*> get_targets() override
+        {
+            return { &_on_true, &_on_false };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Value> _condition;
@@ -196,7 +519,31 @@ namespace irl
 
         ICmp(CondT cond, std::shared_ptr<Variable> out, std::shared_ptr<Value> lhs, std::shared_ptr<Value> rhs, LlvmAtomic tp);
 
-        std::string print() override;
+        CondT get_cond();
+
+        Opcode get_opcode() override
+        {
+            return Opcode::ICMP;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<ICmp>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_lhs, &_rhs };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         CondT _cond;
@@ -219,7 +566,28 @@ namespace irl
 
         void add_branch(std::shared_ptr<Value> val, std::shared_ptr<Variable> origin);
 
-        std::string print() override;
+        std::vector<Node>& get_branches();
+
+        Opcode get_opcode() override
+        {
+            return Opcode::PHI;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Phi>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override;
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Variable> _out;
@@ -232,7 +600,29 @@ namespace irl
     public:
         ZExt(std::shared_ptr<Value> in, LlvmAtomic tp1, std::shared_ptr<Variable> out, LlvmAtomic tp2);
 
-        std::string print() override;
+        Opcode get_opcode() override
+        {
+            return Opcode::ZEXT;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<ZExt>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override
+        {
+            return { &_in };
+        }
+
+        void emit(Emitter& out) override;
 
     private:
         std::shared_ptr<Value> _in;
@@ -246,7 +636,28 @@ namespace irl
 
         void add_param(std::shared_ptr<Value> param);
 
-        std::string print() override;
+        const std::string& get_id();
+
+        Opcode get_opcode() override
+        {
+            return Opcode::CALL;
+        }
+
+        std::unique_ptr<Instruction> clone() override
+        {
+            return std::make_unique<Call>(*this);
+        }
+
+        std::shared_ptr<Variable>* get_out_slot() override
+        {
+            return &_out;
+        }
+
+        std::shared_ptr<Variable> get_out() override;
+
+        std::vector<std::shared_ptr<Value>*> get_operands() override;
+
+        void emit(Emitter& out) override;
     
     private:
         std::string _id;
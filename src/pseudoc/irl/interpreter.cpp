@@ -0,0 +1,745 @@
+#include <pseudoc/irl/interpreter.hpp>
+
+#include <cstring>
+#include <dlfcn.h>
+#include <map>
+#include <stdexcept>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/constant-pool.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+namespace
+{
+    #define BYTECODE_OPS(X) \
+        X(MOVE) \
+        X(ADD32) X(SUB32) X(MUL32) X(DIV32) \
+        X(ADD64) X(SUB64) X(MUL64) X(DIV64) \
+        X(ZEXT) \
+        X(EQ) X(NE) X(SGT) X(SGE) X(SLT) X(SLE) \
+        X(UGT32) X(UGE32) X(ULT32) X(ULE32) \
+        X(UGT64) X(UGE64) X(ULT64) X(ULE64) \
+        X(BR_EQ) X(BR_NE) X(BR_SGT) X(BR_SGE) X(BR_SLT) X(BR_SLE) \
+        X(JUMP) X(JUMPC) X(CALL) X(CALL_NATIVE) X(RET)
+
+    // a = destination, b and c the operands, unless noted:
+    // ZEXT keeps the c low bits of b, BR_* jumps to c when a cmp b holds,
+    // JUMP goes to a, JUMPC to b when a is not zero and to c otherwise.
+    // CALL and CALL_NATIVE call function (native) b with the argument
+    // list at c and write the result to a (when not negative), RET
+    // returns a (when not negative)
+    enum Code : int32_t
+    {
+        #define BYTECODE_ENUM(name) name,
+        BYTECODE_OPS(BYTECODE_ENUM)
+        #undef BYTECODE_ENUM
+    };
+
+    // stack of the frames, in slots
+    constexpr size_t stack_slots = 1 << 20;
+
+    Code compare_code(ICmp::CondT cond, bool wide)
+    {
+        switch (cond)
+        {
+        case ICmp::eq: return EQ;
+        case ICmp::ne: return NE;
+        case ICmp::sgt: return SGT;
+        case ICmp::sge: return SGE;
+        case ICmp::slt: return SLT;
+        case ICmp::sle: return SLE;
+        case ICmp::ugt: return wide ? UGT64 : UGT32;
+        case ICmp::uge: return wide ? UGE64 : UGE32;
+        case ICmp::ult: return wide ? ULT64 : ULT32;
+        default: return wide ? ULE64 : ULE32;
+        }
+    }
+
+    int width(LlvmAtomic tp)
+    {
+        return tp == LlvmAtomic::b ? 1 : atomic_size(tp) * 8;
+    }
+}
+
+namespace irl
+{
+    // one function at a time into Interpreter::Function
+    class BytecodeTranslator
+    {
+    public:
+        BytecodeTranslator(Interpreter& interpreter, IrlSegment& segment, Interpreter::Function& function):
+            _interpreter(interpreter),
+            _segment(segment),
+            _function(function),
+            _cfg(segment),
+            _bound(id_bound(segment))
+        {
+            _uses.assign(_bound, 0);
+
+            for (auto& instruction: segment.instructions)
+            {
+                for (auto operand: instruction->get_operands())
+                {
+                    if (auto var = dynamic_cast<Variable*>(operand->get()))
+                        _uses[var->id]++;
+                }
+            }
+        }
+
+        void run()
+        {
+            auto def = static_cast<Def*>(_segment.instructions.front().get());
+
+            for (auto& param: def->get_params())
+                _function.param_slots.push_back(param->id);
+
+            _block_offsets.resize(_cfg.size());
+            _edges.clear();
+
+            for (int b = 0; b < _cfg.size(); b++)
+            {
+                _block_offsets[b] = _function.code.size();
+                _translate_block(b);
+            }
+
+            // the edges into phis, after every block
+            for (size_t e = 0; e < _edges.size(); e++)
+            {
+                _block_offsets.push_back(_function.code.size());
+                _emit_moves(_edges[e].from, _edges[e].to);
+                _emit({ JUMP, _edges[e].to, 0, 0 });
+            }
+
+            for (size_t target: _targets)
+            {
+                auto& op = _function.code[target];
+
+                if (op.code == JUMP)
+                    op.a = _block_offsets[op.a];
+                else if (op.code == JUMPC)
+                    op.b = _block_offsets[op.b], op.c = _block_offsets[op.c];
+                else
+                    op.c = _block_offsets[op.c];
+            }
+
+            _function.constant_base = _bound;
+            _function.frame_size = _bound + _function.constants.size() + _scratch;
+        }
+
+    private:
+        struct Edge
+        {
+            int from;
+            int to;
+        };
+
+        Interpreter& _interpreter;
+        IrlSegment& _segment;
+        Interpreter::Function& _function;
+        Cfg _cfg;
+        int _bound;
+
+        std::vector<int> _uses;
+        std::map<long, int> _constant_of;
+
+        // extra slots the parallel copies need, after the constants
+        int _scratch = 0;
+
+        std::vector<size_t> _block_offsets;
+        std::vector<Edge> _edges;
+
+        // ops whose targets are still block indices
+        std::vector<size_t> _targets;
+
+        void _emit(Interpreter::Op op)
+        {
+            if (op.code == JUMP || op.code == JUMPC || (op.code >= BR_EQ && op.code <= BR_SLE))
+                _targets.push_back(_function.code.size());
+
+            _function.code.push_back(op);
+        }
+
+        // constants get slots after the temporaries, numbered once the
+        // function is done, so they are kept negative until then
+        int _slot(Value* value)
+        {
+            if (auto var = dynamic_cast<Variable*>(value))
+                return var->id;
+
+            auto literal = dynamic_cast<IntLiteral*>(value);
+
+            if (!literal)
+                throw std::logic_error("interpreter: floating point values are not supported");
+
+            auto it = _constant_of.find(literal->value);
+
+            if (it != _constant_of.end())
+                return it->second;
+
+            int slot = _bound + _function.constants.size();
+            _function.constants.push_back(literal->value);
+            _constant_of.emplace(literal->value, slot);
+            return slot;
+        }
+
+        static bool _is_wide(Value* value)
+        {
+            return value->tp == LlvmAtomic::i64;
+        }
+
+        // copies feeding the phis of to, leaving from
+        void _emit_moves(int from, int to)
+        {
+            std::vector<std::pair<int, int>> moves;
+            auto& label = *_cfg.get_block(from).label;
+            auto& block = _cfg.get_block(to);
+
+            for (size_t i = block.begin + 1; i < block.end; i++)
+            {
+                auto& instruction = _segment.instructions[i];
+
+                if (instruction->get_opcode() != Instruction::PHI)
+                    break;
+
+                auto phi = static_cast<Phi*>(instruction.get());
+
+                for (auto& branch: phi->get_branches())
+                {
+                    if (branch.origin->id == label.id)
+                    {
+                        moves.emplace_back(phi->get_out()->id, _slot(branch.val.get()));
+                        break;
+                    }
+                }
+            }
+
+            // in order, unless a phi reads another one of the block
+            bool conflict = false;
+
+            for (auto& move: moves)
+            {
+                for (auto& other: moves)
+                    conflict = conflict || move.first == other.second;
+            }
+
+            if (!conflict)
+            {
+                for (auto& [dst, src]: moves)
+                    _emit({ MOVE, dst, src, 0 });
+
+                return;
+            }
+
+            // through scratch slots, numbered -1, -2... until the constants
+            // are all known, as they go after them
+            _scratch = std::max(_scratch, static_cast<int>(moves.size()));
+
+            for (size_t i = 0; i < moves.size(); i++)
+                _emit({ MOVE, -1 - static_cast<int>(i), moves[i].second, 0 });
+
+            for (size_t i = 0; i < moves.size(); i++)
+                _emit({ MOVE, moves[i].first, -1 - static_cast<int>(i), 0 });
+        }
+
+        bool _has_phis(int block)
+        {
+            auto& b = _cfg.get_block(block);
+            return b.begin + 1 < b.end && _segment.instructions[b.begin + 1]->get_opcode() == Instruction::PHI;
+        }
+
+        // block index of the edge from -> to, a separate copy block when to has phis
+        int _edge_target(int from, int to)
+        {
+            if (!_has_phis(to))
+                return to;
+
+            _edges.push_back({ from, to });
+            return _cfg.size() + _edges.size() - 1;
+        }
+
+        void _jump(int from, int to)
+        {
+            if (_has_phis(to))
+                _emit_moves(from, to);
+
+            if (to != from + 1)
+                _emit({ JUMP, to, 0, 0 });
+        }
+
+        void _translate_block(int b)
+        {
+            auto& block = _cfg.get_block(b);
+
+            for (size_t i = block.begin + 1; i < block.end; i++)
+            {
+                auto instruction = _segment.instructions[i].get();
+                auto operands = instruction->get_operands();
+
+                switch (instruction->get_opcode())
+                {
+                case Instruction::LOAD:
+                    _emit({ MOVE, instruction->get_out()->id, _slot(operands[0]->get()), 0 });
+                    break;
+
+                case Instruction::STORE:
+                    _emit({ MOVE, _slot(operands[1]->get()), _slot(operands[0]->get()), 0 });
+                    break;
+
+                case Instruction::ADD:
+                case Instruction::SUB:
+                case Instruction::MUL:
+                case Instruction::SDIV:
+                {
+                    static constexpr Code narrow[] = { ADD32, SUB32, MUL32, DIV32 };
+                    static constexpr Code wide[] = { ADD64, SUB64, MUL64, DIV64 };
+
+                    auto res = instruction->get_out();
+                    int index = instruction->get_opcode() - Instruction::ADD;
+                    Code code = _is_wide(res.get()) ? wide[index] : narrow[index];
+
+                    _emit({ code, res->id, _slot(operands[0]->get()), _slot(operands[1]->get()) });
+                    break;
+                }
+
+                case Instruction::ICMP:
+                {
+                    auto cmp = static_cast<ICmp*>(instruction);
+                    auto res = cmp->get_out();
+                    Code code = compare_code(cmp->get_cond(), _is_wide(operands[0]->get()));
+
+                    // a signed compare only feeding the next branch becomes a single op
+                    auto next = _segment.instructions[i + 1].get();
+
+                    if (code >= EQ && code <= SLE && next->get_opcode() == Instruction::JUMPC && _uses[res->id] == 1
+                        && static_cast<JumpC*>(next)->get_condition() == res)
+                    {
+                        auto jump = static_cast<JumpC*>(next);
+                        int on_true = _cfg.get_block_of(*jump->get_on_true());
+                        int on_false = _cfg.get_block_of(*jump->get_on_false());
+
+                        if (on_true != on_false)
+                        {
+                            int lhs = _slot(operands[0]->get());
+                            int rhs = _slot(operands[1]->get());
+
+                            _emit({ static_cast<int32_t>(code - EQ + BR_EQ), lhs, rhs, _edge_target(b, on_true) });
+
+                            int false_target = _edge_target(b, on_false);
+
+                            if (false_target != b + 1)
+                                _emit({ JUMP, false_target, 0, 0 });
+
+                            return;
+                        }
+                    }
+
+                    _emit({ code, res->id, _slot(operands[0]->get()), _slot(operands[1]->get()) });
+                    break;
+                }
+
+                case Instruction::ZEXT:
+                {
+                    auto res = instruction->get_out();
+                    auto in = operands[0]->get();
+
+                    if (in->tp == LlvmAtomic::b)
+                        _emit({ MOVE, res->id, _slot(in), 0 });
+                    else
+                        _emit({ ZEXT, res->id, _slot(in), width(in->tp) });
+
+                    break;
+                }
+
+                case Instruction::CALL:
+                    _translate_call(static_cast<Call*>(instruction), operands);
+                    break;
+
+                case Instruction::RET:
+                    _emit({ RET, operands.empty() ? -1 : _slot(operands[0]->get()), 0, 0 });
+                    break;
+
+                case Instruction::JUMP:
+                    _jump(b, _cfg.get_block_of(*static_cast<Jump*>(instruction)->get_target()));
+                    break;
+
+                case Instruction::JUMPC:
+                {
+                    auto jump = static_cast<JumpC*>(instruction);
+                    int on_true = _cfg.get_block_of(*jump->get_on_true());
+                    int on_false = _cfg.get_block_of(*jump->get_on_false());
+                    auto condition = jump->get_condition().get();
+
+                    if (on_true == on_false)
+                    {
+                        _jump(b, on_true);
+                        break;
+                    }
+
+                    if (auto literal = dynamic_cast<IntLiteral*>(condition))
+                    {
+                        _jump(b, literal->value ? on_true : on_false);
+                        break;
+                    }
+
+                    _emit({ JUMPC, _slot(condition), _edge_target(b, on_true), _edge_target(b, on_false) });
+                    break;
+                }
+
+                default:
+                    // allocas are slots of their own, phis copies on the edges
+                    break;
+                }
+            }
+        }
+
+        void _translate_call(Call* call, std::vector<std::shared_ptr<Value>*>& operands)
+        {
+            auto res = call->get_out();
+            int args = _function.args.size();
+
+            _function.args.push_back(operands.size());
+
+            for (auto operand: operands)
+                _function.args.push_back(_slot(operand->get()));
+
+            auto it = _interpreter._function_of.find(call->get_id());
+
+            if (it != _interpreter._function_of.end())
+            {
+                _emit({ CALL, res ? res->id : -1, it->second, args });
+                return;
+            }
+
+            void* address = dlsym(RTLD_DEFAULT, call->get_id().c_str());
+
+            if (!address)
+                throw std::logic_error("interpreter: unresolved function " + call->get_id());
+
+            if (operands.size() > 6)
+                throw std::logic_error("interpreter: native calls take at most 6 arguments");
+
+            _interpreter._natives.push_back({ address, res ? res->tp : LlvmAtomic::v });
+            _emit({ CALL_NATIVE, res ? res->id : -1, static_cast<int32_t>(_interpreter._natives.size() - 1), args });
+        }
+    };
+}
+
+Interpreter::Interpreter(std::vector<std::unique_ptr<IrlSegment>>& module):
+    _stack(new long[stack_slots]),
+    _stack_size(stack_slots)
+{
+    std::vector<IrlSegment*> definitions;
+
+    for (auto& segment: module)
+    {
+        if (segment->instructions.empty() || segment->instructions.front()->get_opcode() != Instruction::DEF)
+            continue;
+
+        auto def = static_cast<Def*>(segment->instructions.front().get());
+        _function_of[def->get_id()] = definitions.size();
+        definitions.push_back(segment.get());
+    }
+
+    _functions.resize(definitions.size());
+
+    for (size_t f = 0; f < definitions.size(); f++)
+    {
+        _functions[f].name = static_cast<Def*>(definitions[f]->instructions.front().get())->get_id();
+        BytecodeTranslator(*this, *definitions[f], _functions[f]).run();
+
+        // scratch slots were numbered from the end, now that the constants are known
+        auto& function = _functions[f];
+        int scratch_base = function.constant_base + function.constants.size();
+
+        for (auto& op: function.code)
+        {
+            if (op.code == MOVE && op.a < 0)
+                op.a = scratch_base - 1 - op.a;
+
+            if (op.code == MOVE && op.b < 0)
+                op.b = scratch_base - 1 - op.b;
+        }
+    }
+}
+
+long Interpreter::call(const std::string& id, const std::vector<long>& args)
+{
+    auto it = _function_of.find(id);
+
+    if (it == _function_of.end())
+        throw std::logic_error("interpreter: no function " + id);
+
+    auto& function = _functions[it->second];
+
+    if (args.size() != function.param_slots.size())
+        throw std::logic_error("interpreter: wrong number of arguments for " + id);
+
+    long* fp = _stack.get();
+    std::memcpy(fp + function.constant_base, function.constants.data(), function.constants.size() * sizeof(long));
+
+    for (size_t i = 0; i < args.size(); i++)
+        fp[function.param_slots[i]] = args[i];
+
+    return _run(&function, fp);
+}
+
+long Interpreter::_run(const Function* function, long* fp)
+{
+    struct Frame
+    {
+        const Function* function;
+        const Op* pc;
+        long* fp;
+        int32_t dst;
+    };
+
+    std::vector<Frame> frames;
+    const Op* pc = function->code.data();
+    const Op* op;
+    long* stack_end = _stack.get() + _stack_size;
+    long result = 0;
+
+#if defined(__GNUC__)
+    static void* const handlers[] =
+    {
+        #define BYTECODE_LABEL(name) &&op_##name,
+        BYTECODE_OPS(BYTECODE_LABEL)
+        #undef BYTECODE_LABEL
+    };
+
+    #define CASE(name) op_##name:
+    #define DISPATCH() op = pc++; goto *handlers[op->code]
+    #define END_DISPATCH()
+
+    DISPATCH();
+#else
+    #define CASE(name) case name:
+    #define DISPATCH() goto dispatch
+    #define END_DISPATCH() }
+
+dispatch:
+    op = pc++;
+
+    switch (op->code)
+    {
+#endif
+
+    CASE(MOVE)
+        fp[op->a] = fp[op->b];
+        DISPATCH();
+
+    CASE(ADD32)
+        fp[op->a] = static_cast<int32_t>(static_cast<uint32_t>(fp[op->b]) + static_cast<uint32_t>(fp[op->c]));
+        DISPATCH();
+
+    CASE(SUB32)
+        fp[op->a] = static_cast<int32_t>(static_cast<uint32_t>(fp[op->b]) - static_cast<uint32_t>(fp[op->c]));
+        DISPATCH();
+
+    CASE(MUL32)
+        fp[op->a] = static_cast<int32_t>(static_cast<uint32_t>(fp[op->b]) * static_cast<uint32_t>(fp[op->c]));
+        DISPATCH();
+
+    CASE(DIV32)
+        if (fp[op->c] == 0)
+            throw std::runtime_error("interpreter: division by zero");
+
+        // both sides are sign extended, so INT_MIN / -1 only wraps on the way back
+        fp[op->a] = static_cast<int32_t>(fp[op->b] / fp[op->c]);
+        DISPATCH();
+
+    CASE(ADD64)
+        fp[op->a] = static_cast<long>(static_cast<unsigned long>(fp[op->b]) + static_cast<unsigned long>(fp[op->c]));
+        DISPATCH();
+
+    CASE(SUB64)
+        fp[op->a] = static_cast<long>(static_cast<unsigned long>(fp[op->b]) - static_cast<unsigned long>(fp[op->c]));
+        DISPATCH();
+
+    CASE(MUL64)
+        fp[op->a] = static_cast<long>(static_cast<unsigned long>(fp[op->b]) * static_cast<unsigned long>(fp[op->c]));
+        DISPATCH();
+
+    CASE(DIV64)
+        if (fp[op->c] == 0)
+            throw std::runtime_error("interpreter: division by zero");
+
+        fp[op->a] = fp[op->c] == -1 ? static_cast<long>(0 - static_cast<unsigned long>(fp[op->b])) : fp[op->b] / fp[op->c];
+        DISPATCH();
+
+    CASE(ZEXT)
+        fp[op->a] = op->c >= 64 ? fp[op->b] : static_cast<long>(static_cast<unsigned long>(fp[op->b]) & ((1ul << op->c) - 1));
+        DISPATCH();
+
+    CASE(EQ)
+        fp[op->a] = fp[op->b] == fp[op->c];
+        DISPATCH();
+
+    CASE(NE)
+        fp[op->a] = fp[op->b] != fp[op->c];
+        DISPATCH();
+
+    CASE(SGT)
+        fp[op->a] = fp[op->b] > fp[op->c];
+        DISPATCH();
+
+    CASE(SGE)
+        fp[op->a] = fp[op->b] >= fp[op->c];
+        DISPATCH();
+
+    CASE(SLT)
+        fp[op->a] = fp[op->b] < fp[op->c];
+        DISPATCH();
+
+    CASE(SLE)
+        fp[op->a] = fp[op->b] <= fp[op->c];
+        DISPATCH();
+
+    CASE(UGT32)
+        fp[op->a] = static_cast<uint32_t>(fp[op->b]) > static_cast<uint32_t>(fp[op->c]);
+        DISPATCH();
+
+    CASE(UGE32)
+        fp[op->a] = static_cast<uint32_t>(fp[op->b]) >= static_cast<uint32_t>(fp[op->c]);
+        DISPATCH();
+
+    CASE(ULT32)
+        fp[op->a] = static_cast<uint32_t>(fp[op->b]) < static_cast<uint32_t>(fp[op->c]);
+        DISPATCH();
+
+    CASE(ULE32)
+        fp[op->a] = static_cast<uint32_t>(fp[op->b]) <= static_cast<uint32_t>(fp[op->c]);
+        DISPATCH();
+
+    CASE(UGT64)
+        fp[op->a] = static_cast<unsigned long>(fp[op->b]) > static_cast<unsigned long>(fp[op->c]);
+        DISPATCH();
+
+    CASE(UGE64)
+        fp[op->a] = static_cast<unsigned long>(fp[op->b]) >= static_cast<unsigned long>(fp[op->c]);
+        DISPATCH();
+
+    CASE(ULT64)
+        fp[op->a] = static_cast<unsigned long>(fp[op->b]) < static_cast<unsigned long>(fp[op->c]);
+        DISPATCH();
+
+    CASE(ULE64)
+        fp[op->a] = static_cast<unsigned long>(fp[op->b]) <= static_cast<unsigned long>(fp[op->c]);
+        DISPATCH();
+
+    CASE(BR_EQ)
+        if (fp[op->a] == fp[op->b])
+            pc = function->code.data() + op->c;
+
+        DISPATCH();
+
+    CASE(BR_NE)
+        if (fp[op->a] != fp[op->b])
+            pc = function->code.data() + op->c;
+
+        DISPATCH();
+
+    CASE(BR_SGT)
+        if (fp[op->a] > fp[op->b])
+            pc = function->code.data() + op->c;
+
+        DISPATCH();
+
+    CASE(BR_SGE)
+        if (fp[op->a] >= fp[op->b])
+            pc = function->code.data() + op->c;
+
+        DISPATCH();
+
+    CASE(BR_SLT)
+        if (fp[op->a] < fp[op->b])
+            pc = function->code.data() + op->c;
+
+        DISPATCH();
+
+    CASE(BR_SLE)
+        if (fp[op->a] <= fp[op->b])
+            pc = function->code.data() + op->c;
+
+        DISPATCH();
+
+    CASE(JUMP)
+        pc = function->code.data() + op->a;
+        DISPATCH();
+
+    CASE(JUMPC)
+        pc = function->code.data() + (fp[op->a] ? op->b : op->c);
+        DISPATCH();
+
+    CASE(CALL)
+    {
+        auto callee = &_functions[op->b];
+        long* callee_fp = fp + function->frame_size;
+
+        if (callee_fp + callee->frame_size > stack_end)
+            throw std::runtime_error("interpreter: stack overflow");
+
+        std::memcpy(callee_fp + callee->constant_base, callee->constants.data(), callee->constants.size() * sizeof(long));
+
+        const int32_t* args = function->args.data() + op->c;
+
+        for (int32_t i = 0; i < args[0]; i++)
+            callee_fp[callee->param_slots[i]] = fp[args[i + 1]];
+
+        frames.push_back({ function, pc, fp, op->a });
+
+        function = callee;
+        fp = callee_fp;
+        pc = callee->code.data();
+        DISPATCH();
+    }
+
+    CASE(CALL_NATIVE)
+    {
+        auto& native = _natives[op->b];
+        const int32_t* args = function->args.data() + op->c;
+        long a[6] = {};
+
+        for (int32_t i = 0; i < args[0]; i++)
+            a[i] = fp[args[i + 1]];
+
+        // the system v abi passes every integer argument in the same
+        // registers whatever their count, so the widest signature does
+        auto target = reinterpret_cast<long (*)(long, long, long, long, long, long)>(native.address);
+        long value = target(a[0], a[1], a[2], a[3], a[4], a[5]);
+
+        if (op->a >= 0)
+            fp[op->a] = ConstantPool::normalize(native.tp, value);
+
+        DISPATCH();
+    }
+
+    CASE(RET)
+    {
+        result = op->a >= 0 ? fp[op->a] : 0;
+
+        if (frames.empty())
+            return result;
+
+        auto& frame = frames.back();
+        function = frame.function;
+        pc = frame.pc;
+        fp = frame.fp;
+
+        if (frame.dst >= 0)
+            fp[frame.dst] = result;
+
+        frames.pop_back();
+        DISPATCH();
+    }
+
+    END_DISPATCH()
+
+    #undef CASE
+    #undef DISPATCH
+    #undef END_DISPATCH
+
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // runs the functions of a module without a native toolchain. each
+    // definition (renumbered) is translated once into a compact bytecode:
+    // temporaries and constants become slots of a flat frame, allocas are
+    // plain slots loads and stores copy from and to, phis are copies on the
+    // incoming edges and labels are offsets into the code. dispatch jumps
+    // straight from handler to handler (computed goto where the compiler
+    // has it), and calls push frames on an explicit stack, so recursion
+    // depth is only bounded by its size. calls to functions the module
+    // only declares go to the functions of the process with that name
+    class Interpreter
+    {
+    public:
+        Interpreter(std::vector<std::unique_ptr<IrlSegment>>& module);
+
+        Interpreter(Interpreter& other) = delete;
+        Interpreter& operator = (Interpreter& other) = delete;
+
+        bool has_function(const std::string& id) const
+        {
+            return _function_of.count(id) > 0;
+        }
+
+        long call(const std::string& id, const std::vector<long>& args);
+
+    private:
+        friend class BytecodeTranslator;
+
+        struct Op
+        {
+            int32_t code;
+            int32_t a;
+            int32_t b;
+            int32_t c;
+        };
+
+        struct Function
+        {
+            std::string name;
+            std::vector<Op> code;
+
+            // copied to the slots after the temporaries on every call
+            std::vector<long> constants;
+            int constant_base;
+            int frame_size;
+
+            std::vector<int32_t> param_slots;
+
+            // argument lists of the calls: count, then the slots
+            std::vector<int32_t> args;
+        };
+
+        struct Native
+        {
+            void* address;
+            LlvmAtomic tp;
+        };
+
+        std::vector<Function> _functions;
+        std::vector<Native> _natives;
+        std::unordered_map<std::string, int> _function_of;
+
+        std::unique_ptr<long[]> _stack;
+        size_t _stack_size;
+
+        long _run(const Function* function, long* fp);
+    };
+}
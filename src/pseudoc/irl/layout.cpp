@@ -0,0 +1,203 @@
+#include <pseudoc/irl/layout.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <pseudoc/irl/analyses.hpp>
+
+using namespace irl;
+
+namespace
+{
+    struct Edge
+    {
+        int from;
+        int to;
+        double weight;
+        bool back;
+    };
+
+    // static estimate of how often each edge runs
+    std::vector<Edge> weigh_edges(Cfg& cfg, const DominatorTree& dom, const LoopInfo& loops)
+    {
+        std::vector<Edge> edges;
+
+        for (int b = 0; b < cfg.size(); b++)
+        {
+            if (!cfg.is_reachable(b))
+                continue;
+
+            auto successors = cfg.get_successors(b);
+            double frequency = std::pow(10.0, std::min(loops.get_depth(b), 8));
+
+            // successors staying in the innermost loop of the block
+            int staying = 0;
+            int loop = loops.get_loop_of(b);
+
+            for (int succ: successors)
+            {
+                if (loop >= 0 && loops.contains(loop, succ))
+                    staying++;
+            }
+
+            for (int succ: successors)
+            {
+                double probability = 1.0 / successors.size();
+
+                if (staying > 0 && staying < static_cast<int>(successors.size()))
+                {
+                    bool stays = loops.contains(loop, succ);
+                    probability = stays ? 0.9 / staying : 0.1 / (successors.size() - staying);
+                }
+
+                edges.push_back({ b, succ, frequency * probability, dom.dominates(succ, b) });
+            }
+        }
+
+        return edges;
+    }
+}
+
+int irl::layout(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.empty() || instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    Analyses analyses(function);
+    auto& cfg = analyses.get_cfg();
+    int n = cfg.size();
+
+    if (n < 3)
+        return 0;
+
+    auto edges = weigh_edges(cfg, analyses.get_dominators(), analyses.get_loops());
+
+    // chains as linked lists of blocks, known by their head
+    std::vector<int> next(n, -1);
+    std::vector<int> head(n);
+    std::vector<int> tail(n);
+
+    for (int b = 0; b < n; b++)
+        head[b] = tail[b] = b;
+
+    auto link = [&](const Edge& edge)
+    {
+        int from = edge.from;
+        int to = edge.to;
+
+        // the entry stays first, and a chain cannot close on itself
+        if (to == 0 || next[from] >= 0 || head[to] != to || head[from] == to)
+            return;
+
+        next[from] = to;
+
+        int first = head[from];
+        int last = tail[to];
+
+        for (int b = to; b >= 0; b = next[b])
+            head[b] = first;
+
+        tail[first] = last;
+    };
+
+    // rotation: every header goes under its latch, the heavier latches first
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+    {
+        if (a.back != b.back)
+            return a.back;
+
+        return a.weight > b.weight;
+    });
+
+    for (auto& edge: edges)
+    {
+        // a latch ending in a conditional branch falls out of the loop instead
+        if (edge.back && cfg.get_successors(edge.from).size() == 1)
+            link(edge);
+    }
+
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+    {
+        return a.weight > b.weight;
+    });
+
+    for (auto& edge: edges)
+        link(edge);
+
+    std::vector<std::vector<const Edge*>> leaving(n);
+
+    for (auto& edge: edges)
+        leaving[edge.from].push_back(&edge);
+
+    // places the chains, each after the one sending it the heaviest edge
+    std::vector<bool> placed(n, false);
+    std::vector<double> pull(n, 0);
+    std::vector<int> order;
+
+    auto place = [&](int chain)
+    {
+        for (int b = chain; b >= 0; b = next[b])
+        {
+            placed[b] = true;
+            order.push_back(b);
+
+            for (auto edge: leaving[b])
+            {
+                if (!placed[edge->to])
+                    pull[head[edge->to]] += edge->weight;
+            }
+        }
+    };
+
+    place(0);
+
+    while (true)
+    {
+        int best = -1;
+
+        for (int b = 0; b < n; b++)
+        {
+            if (head[b] == b && !placed[b] && (best < 0 || pull[b] > pull[best]))
+                best = b;
+        }
+
+        if (best < 0)
+            break;
+
+        place(best);
+    }
+
+    int moved = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (order[i] != i)
+            moved++;
+    }
+
+    if (moved == 0)
+        return 0;
+
+    std::vector<std::unique_ptr<Instruction>> reordered;
+    reordered.reserve(instructions.size());
+
+    // Def before the entry, EndDef after the last block
+    for (size_t i = 0; i < cfg.get_block(0).begin; i++)
+        reordered.push_back(std::move(instructions[i]));
+
+    for (int b: order)
+    {
+        auto& block = cfg.get_block(b);
+
+        for (size_t i = block.begin; i < block.end; i++)
+            reordered.push_back(std::move(instructions[i]));
+    }
+
+    for (size_t i = cfg.get_block(n - 1).end; i < instructions.size(); i++)
+        reordered.push_back(std::move(instructions[i]));
+
+    instructions = std::move(reordered);
+    return moved;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // orders the blocks so the likely edges fall through. edges are
+    // weighted statically: a block runs 10 times per loop around it, and a
+    // branch stays in its loop 9 times out of 10 (an even split otherwise).
+    // the back edges are laid first, putting every header right after its
+    // latch (loop rotation: the test moves to the bottom and an iteration
+    // takes one branch instead of two), then the blocks are chained along
+    // the heaviest remaining edges, tail to head (Pettis-Hansen). chains
+    // are placed after the entry one, each next to the heaviest edge into
+    // it from the ones placed. the function must be renumbered before and
+    // has to be renumbered again after. returns the number of blocks that
+    // moved
+    int layout(IrlSegment& function);
+}
@@ -0,0 +1,179 @@
+#include <pseudoc/irl/licm.hpp>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/dominators.hpp>
+#include <pseudoc/irl/loops.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+static int id_of(const std::shared_ptr<Value>& value)
+{
+    auto var = dynamic_cast<Variable*>(value.get());
+    return var ? var->id : -1;
+}
+
+// instructions that can run in the preheader even when the loop would not have run them
+static bool can_hoist(Instruction& instruction)
+{
+    switch (instruction.get_opcode())
+    {
+    case Instruction::ADD:
+    case Instruction::SUB:
+    case Instruction::MUL:
+    case Instruction::ICMP:
+    case Instruction::ZEXT:
+    case Instruction::LOAD:
+        return true;
+
+    case Instruction::SDIV:
+    {
+        // only divisions that cannot trap
+        auto divisor = dynamic_cast<IntLiteral*>(instruction.get_operands()[1]->get());
+        return divisor && divisor->value != 0 && divisor->value != -1;
+    }
+
+    default:
+        return false;
+    }
+}
+
+int irl::licm(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.empty() || instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    if (insert_preheaders(function) > 0)
+        renumber(function);
+
+    Cfg cfg(function);
+    DominatorTree dom(cfg);
+    LoopInfo loops(cfg, dom);
+
+    if (loops.size() == 0)
+        return 0;
+
+    // blocks as separate lists, so instructions can move between them
+    int n = cfg.size();
+    std::vector<std::vector<std::unique_ptr<Instruction>>> blocks(n);
+    std::vector<int> def_block(id_bound(function), -1);
+
+    for (int b = 0; b < n; b++)
+    {
+        auto& block = cfg.get_block(b);
+
+        for (size_t i = block.begin; i < block.end; i++)
+        {
+            if (auto out = instructions[i]->get_out())
+                def_block[out->id] = b;
+
+            blocks[b].push_back(std::move(instructions[i]));
+        }
+    }
+
+    int hoisted = 0;
+    std::vector<Value*> stored;
+
+    // inner loops first
+    for (int l = loops.size() - 1; l >= 0; l--)
+    {
+        auto& loop = loops.get_loop(l);
+        int preheader = -1;
+
+        for (int p: cfg.get_predecessors(loop.header))
+        {
+            if (!loops.contains(l, p))
+                preheader = p;
+        }
+
+        if (preheader < 0)
+            continue;
+
+        stored.clear();
+
+        for (int b: loop.blocks)
+        {
+            for (auto& instruction: blocks[b])
+            {
+                if (instruction && instruction->get_opcode() == Instruction::STORE)
+                    stored.push_back(static_cast<Store*>(instruction.get())->get_to().get());
+            }
+        }
+
+        auto invariant = [&](const std::shared_ptr<Value>& value)
+        {
+            int id = id_of(value);
+            return id < 0 || def_block[id] < 0 || !loops.contains(l, def_block[id]);
+        };
+
+        std::vector<std::unique_ptr<Instruction>> moved;
+
+        // rpo keeps every definition ahead of its uses
+        for (int b: cfg.get_rpo())
+        {
+            if (!loops.contains(l, b))
+                continue;
+
+            for (auto& instruction: blocks[b])
+            {
+                if (!instruction || !can_hoist(*instruction))
+                    continue;
+
+                bool hoist = true;
+
+                for (auto operand: instruction->get_operands())
+                    hoist = hoist && invariant(*operand);
+
+                if (hoist && instruction->get_opcode() == Instruction::LOAD)
+                {
+                    auto from = static_cast<Load*>(instruction.get())->get_from().get();
+
+                    for (auto to: stored)
+                        hoist = hoist && to != from;
+                }
+
+                if (!hoist)
+                    continue;
+
+                def_block[instruction->get_out()->id] = preheader;
+                moved.push_back(std::move(instruction));
+            }
+        }
+
+        if (moved.empty())
+            continue;
+
+        auto& target = blocks[preheader];
+        auto terminator = std::move(target.back());
+        target.pop_back();
+
+        for (auto& instruction: moved)
+            target.push_back(std::move(instruction));
+
+        target.push_back(std::move(terminator));
+        hoisted += moved.size();
+    }
+
+    // blocks keep their order, only the instructions inside them changed
+    std::vector<std::unique_ptr<Instruction>> rewritten;
+    rewritten.reserve(instructions.size());
+    rewritten.push_back(std::move(instructions.front()));
+
+    for (auto& block: blocks)
+    {
+        for (auto& instruction: block)
+        {
+            if (instruction)
+                rewritten.push_back(std::move(instruction));
+        }
+    }
+
+    for (size_t i = cfg.get_block(n - 1).end; i < instructions.size(); i++)
+        rewritten.push_back(std::move(instructions[i]));
+
+    instructions = std::move(rewritten);
+
+    return hoisted;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // loop invariant code motion: gives every loop a preheader, then moves
+    // the arithmetic, comparisons and extensions whose operands come from
+    // outside the loop, and the loads of variables the loop never stores
+    // to, to the end of the preheader. inner loops go first, so values
+    // invariant in several levels climb to the outermost one. the function
+    // must be renumbered before and has to be renumbered again after.
+    // returns the number of hoisted instructions
+    int licm(IrlSegment& function);
+}
@@ -0,0 +1,114 @@
+#include <pseudoc/irl/liveness.hpp>
+
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+Liveness::Liveness(IrlSegment& function, Cfg& cfg)
+{
+    int bound = id_bound(function);
+
+    _gen.assign(cfg.size(), BitSet(bound));
+    _kill.assign(cfg.size(), BitSet(bound));
+    _phi_uses.assign(cfg.size(), BitSet(bound));
+    _live_in.assign(cfg.size(), BitSet(bound));
+    _live_out.assign(cfg.size(), BitSet(bound));
+
+    _build_local(function, cfg);
+    _solve(cfg);
+}
+
+void Liveness::_build_local(IrlSegment& function, Cfg& cfg)
+{
+    for (int b = 0; b < cfg.size(); b++)
+    {
+        if (!cfg.is_reachable(b))
+            continue;
+
+        auto& block = cfg.get_block(b);
+        auto& gen = _gen[b];
+        auto& kill = _kill[b];
+
+        for (size_t i = block.begin; i < block.end; i++)
+        {
+            auto& instruction = *function.instructions[i];
+
+            if (instruction.get_opcode() == Instruction::PHI)
+            {
+                for (auto& branch: static_cast<Phi&>(instruction).get_branches())
+                {
+                    auto var = dynamic_cast<Variable*>(branch.val.get());
+                    int from = cfg.get_block_of(*branch.origin);
+
+                    if (var && from >= 0)
+                        _phi_uses[from].set(var->id);
+                }
+            }
+            else
+            {
+                for (auto operand: instruction.get_operands())
+                {
+                    auto var = dynamic_cast<Variable*>(operand->get());
+
+                    if (var && !kill.test(var->id))
+                        gen.set(var->id);
+                }
+            }
+
+            if (auto out = instruction.get_out())
+                kill.set(out->id);
+        }
+    }
+}
+
+void Liveness::_solve(const Cfg& cfg)
+{
+    auto& rpo = cfg.get_rpo();
+
+    // pending blocks by their position on the reverse postorder
+    BitSet pending(rpo.size());
+
+    for (size_t i = 0; i < rpo.size(); i++)
+        pending.set(i);
+
+    bool again = true;
+
+    while (again)
+    {
+        again = false;
+
+        for (int i = rpo.size() - 1; i >= 0; i--)
+        {
+            if (!pending.test(i))
+                continue;
+
+            pending.reset(i);
+            _visits++;
+
+            int b = rpo[i];
+            auto& out = _live_out[b];
+
+            out = _phi_uses[b];
+
+            for (int succ: cfg.get_successors(b))
+                out.unite(_live_in[succ]);
+
+            if (!_live_in[b].assign_transfer(_gen[b], out, _kill[b]))
+                continue;
+
+            for (int pred: cfg.get_predecessors(b))
+            {
+                int index = cfg.get_rpo_index(pred);
+
+                if (index < 0)
+                    continue;
+
+                pending.set(index);
+
+                // a block later on the sweep is still visited in this one
+                if (index >= i)
+                    again = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include <pseudoc/irl/bitset.hpp>
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // values live at the boundaries of every block of a renumbered
+    // function, as bit sets over the value ids. a phi reads its operand at
+    // the end of the incoming edge, so it is live out of that predecessor
+    // and not live into the block of the phi, whose result is defined on
+    // entry. the parameters are live into the entry block when used.
+    // solved backward with a worklist swept in postorder (the reverse
+    // postorder walked from its end), which settles loop-free code in a
+    // single sweep. unreachable blocks are left with empty sets
+    class Liveness
+    {
+    public:
+        Liveness(IrlSegment& function, Cfg& cfg);
+
+        const BitSet& get_live_in(int block) const
+        {
+            return _live_in[block];
+        }
+
+        const BitSet& get_live_out(int block) const
+        {
+            return _live_out[block];
+        }
+
+        bool is_live_in(int block, const Variable& value) const
+        {
+            return _live_in[block].test(value.id);
+        }
+
+        bool is_live_out(int block, const Variable& value) const
+        {
+            return _live_out[block].test(value.id);
+        }
+
+        // number of block visits until the sets settled
+        int get_visits() const
+        {
+            return _visits;
+        }
+
+    private:
+        // values read before any definition in the block, phis excluded
+        std::vector<BitSet> _gen;
+
+        // values defined in the block, phis included
+        std::vector<BitSet> _kill;
+
+        // values the block passes to the phis of its successors
+        std::vector<BitSet> _phi_uses;
+
+        std::vector<BitSet> _live_in;
+        std::vector<BitSet> _live_out;
+
+        int _visits = 0;
+
+        void _build_local(IrlSegment& function, Cfg& cfg);
+        void _solve(const Cfg& cfg);
+    };
+}
@@ -0,0 +1,191 @@
+#include <pseudoc/irl/loops.hpp>
+
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+LoopInfo::LoopInfo(const Cfg& cfg, const DominatorTree& dom):
+    _loop_of(cfg.size(), -1)
+{
+    std::vector<int> stamp(cfg.size(), -1);
+    std::vector<int> work;
+
+    // headers in rpo, so enclosing loops are found before the ones inside them
+    for (int h: cfg.get_rpo())
+    {
+        Loop loop { h, _loop_of[h], 1, {}, { h } };
+
+        for (int p: cfg.get_predecessors(h))
+        {
+            if (dom.dominates(h, p))
+                loop.latches.push_back(p);
+        }
+
+        if (loop.latches.empty())
+            continue;
+
+        int index = _loops.size();
+
+        if (loop.parent >= 0)
+            loop.depth = _loops[loop.parent].depth + 1;
+
+        // the body is everything reaching a latch backward without crossing the header
+        stamp[h] = index;
+
+        for (int latch: loop.latches)
+        {
+            if (stamp[latch] != index)
+            {
+                stamp[latch] = index;
+                work.push_back(latch);
+            }
+        }
+
+        while (!work.empty())
+        {
+            int b = work.back();
+            work.pop_back();
+
+            loop.blocks.push_back(b);
+
+            for (int p: cfg.get_predecessors(b))
+            {
+                if (stamp[p] != index && cfg.is_reachable(p))
+                {
+                    stamp[p] = index;
+                    work.push_back(p);
+                }
+            }
+        }
+
+        // later loops are nested deeper, so the last writer is the innermost loop
+        for (int b: loop.blocks)
+            _loop_of[b] = index;
+
+        _loops.push_back(std::move(loop));
+    }
+}
+
+bool LoopInfo::contains(int loop, int block) const
+{
+    for (int l = _loop_of[block]; l >= 0; l = _loops[l].parent)
+    {
+        if (l == loop)
+            return true;
+    }
+
+    return false;
+}
+
+int irl::insert_preheaders(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.empty() || instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    Cfg cfg(function);
+    DominatorTree dom(cfg);
+    LoopInfo loops(cfg, dom);
+
+    // new blocks go right before their header, indexed by the header label position
+    std::vector<std::vector<std::unique_ptr<Instruction>>> before(instructions.size());
+    int inserted = 0;
+
+    for (int l = 0; l < loops.size(); l++)
+    {
+        auto& loop = loops.get_loop(l);
+        auto& header = cfg.get_block(loop.header);
+
+        std::vector<int> outside;
+
+        for (int p: cfg.get_predecessors(loop.header))
+        {
+            if (!loops.contains(l, p))
+                outside.push_back(p);
+        }
+
+        // the entry has no way in to redirect
+        if (outside.empty() || (outside.size() == 1 && cfg.get_successors(outside[0]).size() == 1))
+            continue;
+
+        auto label = std::make_shared<Variable>();
+        label->tp = LlvmAtomic::v;
+
+        auto& block = before[header.begin];
+        block.push_back(std::make_unique<Label>(label));
+
+        for (int p: outside)
+        {
+            auto& last = instructions[cfg.get_block(p).end - 1];
+
+            for (auto target: last->get_targets())
+            {
+                if (*target == header.label)
+                    *target = label;
+            }
+        }
+
+        // the outside edges of each header phi now arrive through the preheader
+        for (size_t i = header.begin + 1; i < header.end && instructions[i]->get_opcode() == Instruction::PHI; i++)
+        {
+            auto phi = static_cast<Phi*>(instructions[i].get());
+            auto& branches = phi->get_branches();
+
+            std::vector<Phi::Node> inside;
+            std::vector<Phi::Node> entering;
+
+            for (auto& branch: branches)
+            {
+                if (loops.contains(l, cfg.get_block_of(*branch.origin)))
+                    inside.push_back(std::move(branch));
+                else
+                    entering.push_back(std::move(branch));
+            }
+
+            std::shared_ptr<Value> value;
+
+            if (entering.size() == 1)
+            {
+                value = std::move(entering[0].val);
+            }
+            else
+            {
+                auto out = std::make_shared<Variable>();
+                out->tp = phi->get_out()->tp;
+
+                auto merge = std::make_unique<Phi>(out, out->tp);
+
+                for (auto& branch: entering)
+                    merge->add_branch(std::move(branch.val), std::move(branch.origin));
+
+                block.push_back(std::move(merge));
+                value = std::move(out);
+            }
+
+            inside.push_back({ std::move(value), label });
+            branches = std::move(inside);
+        }
+
+        block.push_back(std::make_unique<Jump>(header.label));
+        inserted++;
+    }
+
+    if (inserted == 0)
+        return 0;
+
+    std::vector<std::unique_ptr<Instruction>> rewritten;
+    rewritten.reserve(instructions.size() + inserted * 2);
+
+    for (size_t i = 0; i < instructions.size(); i++)
+    {
+        for (auto& instruction: before[i])
+            rewritten.push_back(std::move(instruction));
+
+        rewritten.push_back(std::move(instructions[i]));
+    }
+
+    instructions = std::move(rewritten);
+
+    return inserted;
+}
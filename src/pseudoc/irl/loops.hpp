@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/dominators.hpp>
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    struct Loop
+    {
+        int header;
+
+        // enclosing loop, -1 for the outermost ones
+        int parent;
+
+        // 1 for the outermost loops
+        int depth;
+
+        // blocks jumping back to the header
+        std::vector<int> latches;
+
+        // every block of the loop, nested loops included, the header first
+        std::vector<int> blocks;
+    };
+
+    // natural loops of a cfg: each edge to a block dominating its source
+    // closes a loop on that header, and the loops sharing a header are
+    // merged. loops are numbered outer before inner, so walking them
+    // backward visits every loop before the ones enclosing it
+    class LoopInfo
+    {
+    public:
+        LoopInfo(const Cfg& cfg, const DominatorTree& dom);
+
+        int size() const
+        {
+            return _loops.size();
+        }
+
+        const Loop& get_loop(int loop) const
+        {
+            return _loops[loop];
+        }
+
+        // innermost loop holding the block, -1 when it is in no loop
+        int get_loop_of(int block) const
+        {
+            return _loop_of[block];
+        }
+
+        // number of loops around the block
+        int get_depth(int block) const
+        {
+            return _loop_of[block] < 0 ? 0 : _loops[_loop_of[block]].depth;
+        }
+
+        bool contains(int loop, int block) const;
+
+    private:
+        std::vector<Loop> _loops;
+        std::vector<int> _loop_of;
+    };
+
+    // gives every loop a preheader: a block outside the loop that is its
+    // single way in, ending in a jump to the header. header phis merging
+    // several outside edges get their merge moved to a phi of the
+    // preheader. the function must be renumbered before and has to be
+    // renumbered again after. returns the number of inserted blocks
+    int insert_preheaders(IrlSegment& function);
+}
@@ -0,0 +1,391 @@
+#include <pseudoc/irl/mem2reg.hpp>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/dominators.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+// value read from a variable before any store, the program reading it is undefined anyway
+static std::shared_ptr<Value> zero(ConstantPool& constants, LlvmAtomic tp)
+{
+    if (tp == LlvmAtomic::fp)
+        return constants.get_float(0);
+
+    if (tp == LlvmAtomic::db)
+        return constants.get_double(0);
+
+    return constants.get_int(tp, 0);
+}
+
+namespace
+{
+    class Promoter
+    {
+    public:
+        Promoter(IrlSegment& function, ConstantPool& constants):
+            _instructions(function.instructions),
+            _constants(constants),
+            _cfg(function),
+            _dom(_cfg),
+            _slot_of(id_bound(function), -1),
+            _replacement(_slot_of.size())
+        {
+        }
+
+        int run()
+        {
+            _find_allocas();
+
+            if (_allocas.empty())
+                return 0;
+
+            _place_phis();
+            _rename();
+            _rewrite();
+
+            return _allocas.size();
+        }
+
+    private:
+        struct NewPhi
+        {
+            int slot;
+            std::unique_ptr<Phi> phi;
+        };
+
+        std::vector<std::unique_ptr<Instruction>>& _instructions;
+        ConstantPool& _constants;
+        Cfg _cfg;
+        DominatorTree _dom;
+
+        // promoted alloca of each variable id, -1 for everything else
+        std::vector<int> _slot_of;
+        std::vector<std::shared_ptr<Variable>> _allocas;
+
+        // value replacing each promoted load, by id of the load
+        std::vector<std::shared_ptr<Value>> _replacement;
+
+        std::vector<std::vector<NewPhi>> _phis;
+
+        int _slot(const std::shared_ptr<Value>& value)
+        {
+            auto var = dynamic_cast<Variable*>(value.get());
+
+            if (!var || var->id < 0 || var->id >= static_cast<int>(_slot_of.size()))
+                return -1;
+
+            return _slot_of[var->id];
+        }
+
+        std::shared_ptr<Value> _resolve(const std::shared_ptr<Value>& value)
+        {
+            auto var = dynamic_cast<Variable*>(value.get());
+
+            if (!var || var->id < 0 || var->id >= static_cast<int>(_replacement.size()) || !_replacement[var->id])
+                return value;
+
+            return _replacement[var->id];
+        }
+
+        void _find_allocas()
+        {
+            for (auto& instruction: _instructions)
+            {
+                if (instruction->get_opcode() != Instruction::ALLOCA)
+                    continue;
+
+                auto var = instruction->get_out();
+                _slot_of[var->id] = _allocas.size();
+                _allocas.push_back(var);
+            }
+
+            // any use besides the address of a load or store lets the pointer escape
+            std::vector<bool> escapes(_allocas.size(), false);
+
+            for (auto& instruction: _instructions)
+            {
+                auto op = instruction->get_opcode();
+                auto operands = instruction->get_operands();
+
+                for (size_t i = 0; i < operands.size(); i++)
+                {
+                    int slot = _slot(*operands[i]);
+
+                    if (slot < 0)
+                        continue;
+
+                    if ((op == Instruction::LOAD && i == 0) || (op == Instruction::STORE && i == 1))
+                        continue;
+
+                    escapes[slot] = true;
+                }
+            }
+
+            std::vector<std::shared_ptr<Variable>> promoted;
+
+            for (size_t slot = 0; slot < _allocas.size(); slot++)
+            {
+                auto& var = _allocas[slot];
+
+                if (escapes[slot])
+                {
+                    _slot_of[var->id] = -1;
+                    continue;
+                }
+
+                _slot_of[var->id] = promoted.size();
+                promoted.push_back(var);
+            }
+
+            _allocas = std::move(promoted);
+        }
+
+        void _place_phis()
+        {
+            int n = _cfg.size();
+            int slots = _allocas.size();
+
+            // reachable blocks storing to each slot
+            std::vector<std::vector<int>> defs(slots);
+            std::vector<int> last_def(slots, -1);
+
+            for (int b: _cfg.get_rpo())
+            {
+                auto& block = _cfg.get_block(b);
+
+                for (size_t i = block.begin; i < block.end; i++)
+                {
+                    auto& instruction = _instructions[i];
+
+                    if (instruction->get_opcode() != Instruction::STORE)
+                        continue;
+
+                    int slot = _slot(static_cast<Store*>(instruction.get())->get_to());
+
+                    if (slot >= 0 && last_def[slot] != b)
+                    {
+                        last_def[slot] = b;
+                        defs[slot].push_back(b);
+                    }
+                }
+            }
+
+            _phis.resize(n);
+
+            // per block marks stamped with the slot, so they never need clearing
+            std::vector<int> has_phi(n, -1);
+            std::vector<int> queued(n, -1);
+            std::vector<int> work;
+
+            for (int slot = 0; slot < slots; slot++)
+            {
+                work = defs[slot];
+
+                for (int b: work)
+                    queued[b] = slot;
+
+                while (!work.empty())
+                {
+                    int x = work.back();
+                    work.pop_back();
+
+                    for (int y: _dom.get_frontier(x))
+                    {
+                        if (has_phi[y] == slot)
+                            continue;
+
+                        has_phi[y] = slot;
+
+                        auto tp = _allocas[slot]->tp;
+                        auto out = std::make_shared<Variable>();
+                        out->tp = tp;
+
+                        _phis[y].push_back({ slot, std::make_unique<Phi>(std::move(out), tp) });
+
+                        if (queued[y] != slot)
+                        {
+                            queued[y] = slot;
+                            work.push_back(y);
+                        }
+                    }
+                }
+            }
+        }
+
+        // drops the promoted allocas, loads and stores of a block, with
+        // stacks holding the reaching value of each slot
+        void _rename_block(int b, std::vector<std::vector<std::shared_ptr<Value>>>& stacks, std::vector<int>& pushed)
+        {
+            auto& block = _cfg.get_block(b);
+
+            for (auto& phi: _phis[b])
+            {
+                stacks[phi.slot].push_back(phi.phi->get_out());
+                pushed.push_back(phi.slot);
+            }
+
+            for (size_t i = block.begin + 1; i < block.end; i++)
+            {
+                auto& instruction = _instructions[i];
+
+                switch (instruction->get_opcode())
+                {
+                case Instruction::ALLOCA:
+                    if (_slot(instruction->get_out()) >= 0)
+                        instruction.reset();
+
+                    break;
+
+                case Instruction::LOAD:
+                {
+                    int slot = _slot(static_cast<Load*>(instruction.get())->get_from());
+
+                    if (slot < 0)
+                        break;
+
+                    auto& stack = stacks[slot];
+                    _replacement[instruction->get_out()->id] = stack.empty() ? zero(_constants, _allocas[slot]->tp) : stack.back();
+                    instruction.reset();
+                    break;
+                }
+
+                case Instruction::STORE:
+                {
+                    auto store = static_cast<Store*>(instruction.get());
+                    int slot = _slot(store->get_to());
+
+                    if (slot < 0)
+                        break;
+
+                    stacks[slot].push_back(_resolve(store->get_from()));
+                    pushed.push_back(slot);
+                    instruction.reset();
+                    break;
+                }
+
+                default:
+                    break;
+                }
+            }
+
+            for (int s: _cfg.get_successors(b))
+            {
+                for (auto& phi: _phis[s])
+                {
+                    auto& stack = stacks[phi.slot];
+                    phi.phi->add_branch(stack.empty() ? zero(_constants, _allocas[phi.slot]->tp) : stack.back(), block.label);
+                }
+            }
+        }
+
+        void _rename()
+        {
+            std::vector<std::vector<std::shared_ptr<Value>>> stacks(_allocas.size());
+            std::vector<int> pushed;
+
+            // iterative preorder walk of the dominator tree, each frame keeps
+            // the size of the push log to unwind when the subtree is done
+            struct Frame
+            {
+                int block;
+                const int* next;
+                size_t log;
+            };
+
+            std::vector<Frame> walk;
+
+            walk.push_back({ 0, _dom.get_children(0).begin(), pushed.size() });
+            _rename_block(0, stacks, pushed);
+
+            while (!walk.empty())
+            {
+                auto& frame = walk.back();
+
+                if (frame.next != _dom.get_children(frame.block).end())
+                {
+                    int child = *frame.next++;
+
+                    walk.push_back({ child, _dom.get_children(child).begin(), pushed.size() });
+                    _rename_block(child, stacks, pushed);
+                    continue;
+                }
+
+                while (pushed.size() > frame.log)
+                {
+                    stacks[pushed.back()].pop_back();
+                    pushed.pop_back();
+                }
+
+                walk.pop_back();
+            }
+
+            // unreachable code never runs, so its reads see zero and its
+            // edges only have to feed the phis something of the right type
+            std::vector<std::vector<std::shared_ptr<Value>>> empty(_allocas.size());
+            std::vector<int> scratch;
+
+            for (int b = 0; b < _cfg.size(); b++)
+            {
+                if (!_cfg.is_reachable(b))
+                {
+                    _rename_block(b, empty, scratch);
+
+                    for (int slot: scratch)
+                        empty[slot].clear();
+
+                    scratch.clear();
+                }
+            }
+        }
+
+        // points the remaining uses of promoted loads at their values and
+        // puts the new phis at the top of their blocks
+        void _rewrite()
+        {
+            for (auto& instruction: _instructions)
+            {
+                if (!instruction)
+                    continue;
+
+                for (auto operand: instruction->get_operands())
+                    *operand = _resolve(*operand);
+            }
+
+            std::vector<std::unique_ptr<Instruction>> rewritten;
+            rewritten.reserve(_instructions.size());
+
+            size_t next = 0;
+
+            for (int b = 0; b < _cfg.size(); b++)
+            {
+                auto& block = _cfg.get_block(b);
+
+                for (; next <= block.begin; next++)
+                {
+                    if (_instructions[next])
+                        rewritten.push_back(std::move(_instructions[next]));
+                }
+
+                for (auto& phi: _phis[b])
+                    rewritten.push_back(std::move(phi.phi));
+            }
+
+            for (; next < _instructions.size(); next++)
+            {
+                if (_instructions[next])
+                    rewritten.push_back(std::move(_instructions[next]));
+            }
+
+            _instructions = std::move(rewritten);
+        }
+    };
+}
+
+int irl::mem2reg(IrlSegment& function, ConstantPool& constants)
+{
+    if (function.instructions.empty() || function.instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    return Promoter(function, constants).run();
+}
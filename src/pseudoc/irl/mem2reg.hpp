@@ -0,0 +1,14 @@
+#pragma once
+
+#include <pseudoc/irl/constant-pool.hpp>
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // promotes the allocas that are only read by loads and written by stores
+    // into ssa values, placing phis at the iterated dominance frontier of
+    // the stores and renaming along the dominator tree. the function must
+    // be renumbered before and has to be renumbered again after. returns
+    // the number of promoted allocas
+    int mem2reg(IrlSegment& function, ConstantPool& constants);
+}
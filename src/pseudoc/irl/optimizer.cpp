@@ -0,0 +1,58 @@
+#include <pseudoc/irl/optimizer.hpp>
+
+#include <pseudoc/irl/dce.hpp>
+#include <pseudoc/irl/gvn.hpp>
+#include <pseudoc/irl/layout.hpp>
+#include <pseudoc/irl/licm.hpp>
+#include <pseudoc/irl/mem2reg.hpp>
+#include <pseudoc/irl/peephole.hpp>
+#include <pseudoc/irl/renumber.hpp>
+#include <pseudoc/irl/sccp.hpp>
+#include <pseudoc/irl/tce.hpp>
+
+using namespace irl;
+
+void irl::optimize(IrlSegment& function, ConstantPool& constants, int level, Statistics& stats)
+{
+    if (level < 1 || function.instructions.empty() || function.instructions.front()->get_opcode() != Instruction::DEF)
+        return;
+
+    // the redundancies of the naive codegen go first, so the passes see less code
+    peephole(function, stats);
+    renumber(function);
+
+    stats.add("mem2reg - allocas promoted", mem2reg(function, constants));
+    renumber(function);
+
+    if (level >= 2)
+    {
+        stats.add("tce - tail calls eliminated", tce(function));
+        renumber(function);
+    }
+
+    stats.add("sccp - values folded", sccp(function, constants));
+    renumber(function);
+
+    int eliminated = gvn(function);
+    auto& name = static_cast<Def*>(function.instructions.front().get())->get_id();
+
+    stats.add("gvn - instructions eliminated", eliminated);
+    stats.add("gvn - instructions eliminated in @" + name, eliminated);
+    renumber(function);
+
+    stats.add("licm - instructions hoisted", licm(function));
+    renumber(function);
+
+    stats.add("dce - instructions removed", dce(function));
+    renumber(function);
+
+    // and then the jumps between blocks the passes left in a straight line
+    peephole(function, stats);
+    renumber(function);
+
+    if (level >= 2)
+    {
+        stats.add("layout - blocks moved", layout(function));
+        renumber(function);
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <pseudoc/irl/constant-pool.hpp>
+#include <pseudoc/irl/segment.hpp>
+#include <pseudoc/irl/statistics.hpp>
+
+namespace irl
+{
+    // runs the passes of the optimization level over a renumbered function,
+    // leaving it renumbered. level 0 leaves the code as generated
+    void optimize(IrlSegment& function, ConstantPool& constants, int level, Statistics& stats);
+}
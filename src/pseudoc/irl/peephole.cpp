@@ -0,0 +1,204 @@
+#include <pseudoc/irl/peephole.hpp>
+
+#include <iterator>
+#include <string>
+
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+namespace
+{
+    struct Window
+    {
+        // instructions kept so far, the window is their tail plus the current one
+        std::vector<std::unique_ptr<Instruction>> code;
+
+        // number of jumps to each label, and whether it starts with phis
+        std::vector<int> references;
+        std::vector<bool> has_phis;
+
+        // label of the block being written
+        std::shared_ptr<Variable> block_label;
+
+        // uses of an id read this value instead
+        std::vector<std::shared_ptr<Value>> replaced;
+
+        // phis coming from a merged block come from this label instead
+        std::vector<std::shared_ptr<Variable>> merged_into;
+    };
+
+    struct Pattern
+    {
+        const char* name;
+
+        // true when the current instruction was rewritten away
+        bool (*apply)(Window& window, std::unique_ptr<Instruction>& current);
+    };
+
+    Variable* as_variable(const std::shared_ptr<Value>& value)
+    {
+        return dynamic_cast<Variable*>(value.get());
+    }
+
+    bool jump_to_next(Window& window, std::unique_ptr<Instruction>& current)
+    {
+        if (current->get_opcode() != Instruction::LABEL || window.code.empty())
+            return false;
+
+        auto& last = window.code.back();
+        auto label = *current->get_out_slot();
+
+        if (last->get_opcode() != Instruction::JUMP || static_cast<Jump*>(last.get())->get_target() != label)
+            return false;
+
+        if (window.references[label->id] != 1 || window.has_phis[label->id])
+            return false;
+
+        window.merged_into[label->id] = window.block_label;
+        window.code.pop_back();
+        return true;
+    }
+
+    bool load_after_store(Window& window, std::unique_ptr<Instruction>& current)
+    {
+        if (current->get_opcode() != Instruction::LOAD || window.code.empty())
+            return false;
+
+        auto& last = window.code.back();
+
+        if (last->get_opcode() != Instruction::STORE)
+            return false;
+
+        auto store = static_cast<Store*>(last.get());
+        auto load = static_cast<Load*>(current.get());
+
+        if (store->get_to() != load->get_from())
+            return false;
+
+        window.replaced[current->get_out()->id] = store->get_from();
+        return true;
+    }
+
+    bool compare_of_bool(Window& window, std::unique_ptr<Instruction>& current)
+    {
+        if (current->get_opcode() != Instruction::ICMP || static_cast<ICmp*>(current.get())->get_cond() != ICmp::ne)
+            return false;
+
+        auto operands = current->get_operands();
+        auto zero = dynamic_cast<IntLiteral*>(operands[1]->get());
+
+        if (operands[0]->get()->tp != LlvmAtomic::b || !zero || zero->value != 0)
+            return false;
+
+        window.replaced[current->get_out()->id] = *operands[0];
+        return true;
+    }
+
+    const Pattern patterns[] = {
+        { "jump to the next label", jump_to_next },
+        { "load of the stored value", load_after_store },
+        { "icmp ne of an i1", compare_of_bool }
+    };
+}
+
+int irl::peephole(IrlSegment& function, Statistics& stats)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.empty() || instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    int bound = id_bound(function);
+    Window window;
+
+    window.references.assign(bound, 0);
+    window.has_phis.assign(bound, false);
+    window.replaced.resize(bound);
+    window.merged_into.resize(bound);
+
+    std::shared_ptr<Variable> label;
+
+    for (auto& instruction: instructions)
+    {
+        if (instruction->get_opcode() == Instruction::LABEL)
+            label = *instruction->get_out_slot();
+        else if (instruction->get_opcode() == Instruction::PHI)
+            window.has_phis[label->id] = true;
+
+        for (auto target: instruction->get_targets())
+            window.references[(*target)->id]++;
+    }
+
+    // a replacement may itself have been replaced
+    auto resolve = [&](std::shared_ptr<Value>& value)
+    {
+        while (auto var = as_variable(value))
+        {
+            if (var->id < 0 || var->id >= bound || !window.replaced[var->id])
+                break;
+
+            value = window.replaced[var->id];
+        }
+    };
+
+    int hits[std::size(patterns)] = {};
+
+    for (auto& instruction: instructions)
+    {
+        for (auto operand: instruction->get_operands())
+            resolve(*operand);
+
+        bool rewritten = false;
+
+        for (size_t p = 0; p < std::size(patterns) && !rewritten; p++)
+        {
+            if (patterns[p].apply(window, instruction))
+            {
+                hits[p]++;
+                rewritten = true;
+            }
+        }
+
+        if (rewritten)
+            continue;
+
+        if (instruction->get_opcode() == Instruction::LABEL)
+            window.block_label = *instruction->get_out_slot();
+
+        window.code.push_back(std::move(instruction));
+    }
+
+    int total = 0;
+
+    for (size_t p = 0; p < std::size(patterns); p++)
+    {
+        stats.add(std::string("peephole - ") + patterns[p].name, hits[p]);
+        total += hits[p];
+    }
+
+    if (total == 0)
+    {
+        instructions = std::move(window.code);
+        return 0;
+    }
+
+    // phis read values defined later on loops, and name the merged blocks
+    for (auto& instruction: window.code)
+    {
+        for (auto operand: instruction->get_operands())
+            resolve(*operand);
+
+        if (instruction->get_opcode() != Instruction::PHI)
+            continue;
+
+        for (auto& branch: static_cast<Phi*>(instruction.get())->get_branches())
+        {
+            if (auto& into = window.merged_into[branch.origin->id])
+                branch.origin = into;
+        }
+    }
+
+    instructions = std::move(window.code);
+    return total;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+#include <pseudoc/irl/statistics.hpp>
+
+namespace irl
+{
+    // rewrites short windows of instructions through a table of patterns,
+    // each window ending at the instruction being read, so a rewrite can
+    // expose the next one:
+    //  - a jump to the label right after it, when that label has no other
+    //    way in and no phis, merges the two blocks
+    //  - a load right after a store to the same pointer reads the stored value
+    //  - icmp ne of an i1 against 0 (a boolean cast of a comparison) is the i1
+    // every pattern counts its hits on the statistics. the function must be
+    // renumbered before and has to be renumbered again after. returns the
+    // number of rewrites
+    int peephole(IrlSegment& function, Statistics& stats);
+}
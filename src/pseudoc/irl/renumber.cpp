@@ -0,0 +1,68 @@
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+void irl::renumber(IrlSegment& function)
+{
+    std::vector<std::unique_ptr<Instruction>> numbered;
+    numbered.reserve(function.instructions.size());
+
+    int next = 0;
+    bool after_terminator = false;
+
+    for (auto& instruction: function.instructions)
+    {
+        auto op = instruction->get_opcode();
+
+        if (after_terminator && op != Instruction::LABEL && op != Instruction::END_DEF)
+        {
+            auto label = std::make_shared<Variable>();
+            label->tp = LlvmAtomic::v;
+            label->id = next++;
+
+            numbered.push_back(std::make_unique<Label>(std::move(label)));
+        }
+
+        if (op == Instruction::DEF)
+        {
+            for (auto& param: static_cast<Def*>(instruction.get())->get_params())
+                param->id = next++;
+        }
+        else if (op == Instruction::LABEL)
+        {
+            static_cast<Label*>(instruction.get())->get_ref()->id = next++;
+        }
+        else if (auto out = instruction->get_out())
+        {
+            out->id = next++;
+        }
+
+        after_terminator = instruction->is_terminator();
+        numbered.push_back(std::move(instruction));
+    }
+
+    function.instructions = std::move(numbered);
+}
+
+int irl::id_bound(IrlSegment& function)
+{
+    // ids grow in program order, so the last numbered instruction holds the highest
+    for (auto it = function.instructions.rbegin(); it != function.instructions.rend(); ++it)
+    {
+        auto& instruction = *it;
+
+        if (instruction->get_opcode() == Instruction::LABEL)
+            return static_cast<Label*>(instruction.get())->get_ref()->id + 1;
+
+        if (instruction->get_opcode() == Instruction::DEF)
+        {
+            auto& params = static_cast<Def*>(instruction.get())->get_params();
+            return params.empty() ? 0 : params.back()->id + 1;
+        }
+
+        if (auto out = instruction->get_out())
+            return out->id + 1;
+    }
+
+    return 0;
+}
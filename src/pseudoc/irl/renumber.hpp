@@ -0,0 +1,15 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // assigns the sequential %N names of a finished function in the order
+    // llvm expects them: the params, then every label and defined value in
+    // program order. code after a terminator that does not start with a
+    // label gets one, since llvm numbers those blocks implicitly
+    void renumber(IrlSegment& function);
+
+    // one past the highest id of a renumbered function, to size tables indexed by id
+    int id_bound(IrlSegment& function);
+}
@@ -0,0 +1,486 @@
+#include <pseudoc/irl/sccp.hpp>
+
+#include <algorithm>
+
+#include <pseudoc/irl/cfg.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+namespace
+{
+    struct Lattice
+    {
+        enum State : char
+        {
+            unknown,
+            constant,
+            overdefined
+        };
+
+        State state = unknown;
+        long value = 0;
+    };
+
+    // bits of the integer type, i1 included
+    int width(LlvmAtomic tp)
+    {
+        return tp == LlvmAtomic::b ? 1 : atomic_size(tp) * 8;
+    }
+
+    unsigned long as_unsigned(LlvmAtomic tp, long value)
+    {
+        int bits = width(tp);
+        return bits == 64 ? value : value & ((1ul << bits) - 1);
+    }
+
+    bool compare(ICmp::CondT cond, LlvmAtomic tp, long lhs, long rhs)
+    {
+        unsigned long ulhs = as_unsigned(tp, lhs);
+        unsigned long urhs = as_unsigned(tp, rhs);
+
+        switch (cond)
+        {
+        case ICmp::eq: return lhs == rhs;
+        case ICmp::ne: return lhs != rhs;
+        case ICmp::ugt: return ulhs > urhs;
+        case ICmp::uge: return ulhs >= urhs;
+        case ICmp::ult: return ulhs < urhs;
+        case ICmp::ule: return ulhs <= urhs;
+        case ICmp::sgt: return lhs > rhs;
+        case ICmp::sge: return lhs >= rhs;
+        case ICmp::slt: return lhs < rhs;
+        case ICmp::sle: return lhs <= rhs;
+        }
+
+        return false;
+    }
+
+    bool is_int(LlvmAtomic tp)
+    {
+        return tp == LlvmAtomic::b || (tp >= LlvmAtomic::i8 && tp <= LlvmAtomic::i64);
+    }
+
+    class Propagator
+    {
+    public:
+        Propagator(IrlSegment& function, ConstantPool& constants):
+            _instructions(function.instructions),
+            _constants(constants),
+            _cfg(function),
+            _values(id_bound(function)),
+            _def_of(_values.size(), -1),
+            _block_of(_instructions.size(), -1),
+            _executable_edge(_cfg.edge_count(), false),
+            _executable_block(_cfg.size(), false)
+        {
+        }
+
+        int run()
+        {
+            _index();
+            _propagate();
+            return _rewrite();
+        }
+
+    private:
+        std::vector<std::unique_ptr<Instruction>>& _instructions;
+        ConstantPool& _constants;
+        Cfg _cfg;
+
+        std::vector<Lattice> _values;
+        std::vector<int> _def_of;
+        std::vector<int> _block_of;
+
+        // instructions using each value, in compact adjacency arrays
+        std::vector<int> _use_offsets;
+        std::vector<int> _uses;
+
+        std::vector<bool> _executable_edge;
+        std::vector<bool> _executable_block;
+
+        std::vector<int> _block_work;
+        std::vector<int> _value_work;
+
+        static int _id(const std::shared_ptr<Value>& value)
+        {
+            auto var = dynamic_cast<Variable*>(value.get());
+            return var ? var->id : -1;
+        }
+
+        Lattice _get(const std::shared_ptr<Value>& value)
+        {
+            if (auto literal = dynamic_cast<IntLiteral*>(value.get()))
+                return { Lattice::constant, literal->value };
+
+            int id = _id(value);
+
+            // params and anything not defined here are overdefined from the start
+            if (id < 0 || _def_of[id] < 0)
+                return { Lattice::overdefined, 0 };
+
+            return _values[id];
+        }
+
+        void _index()
+        {
+            std::vector<std::pair<int, int>> uses;
+
+            for (int b = 0; b < _cfg.size(); b++)
+            {
+                auto& block = _cfg.get_block(b);
+
+                for (size_t i = block.begin; i < block.end; i++)
+                    _block_of[i] = b;
+            }
+
+            for (size_t i = 0; i < _instructions.size(); i++)
+            {
+                auto& instruction = _instructions[i];
+
+                if (auto out = instruction->get_out())
+                    _def_of[out->id] = i;
+
+                for (auto operand: instruction->get_operands())
+                {
+                    int id = _id(*operand);
+
+                    if (id >= 0)
+                        uses.push_back({ id, static_cast<int>(i) });
+                }
+            }
+
+            int n = _values.size();
+            _use_offsets.assign(n + 1, 0);
+
+            for (auto& use: uses)
+                _use_offsets[use.first + 1]++;
+
+            for (int v = 0; v < n; v++)
+                _use_offsets[v + 1] += _use_offsets[v];
+
+            _uses.resize(uses.size());
+            std::vector<int> fill(_use_offsets.begin(), _use_offsets.end() - 1);
+
+            for (auto& use: uses)
+                _uses[fill[use.first]++] = use.second;
+        }
+
+        void _lower(const std::shared_ptr<Variable>& out, Lattice next)
+        {
+            auto& current = _values[out->id];
+
+            if (current.state == Lattice::overdefined || next.state == Lattice::unknown)
+                return;
+
+            if (current.state == Lattice::constant && next.state == Lattice::constant && current.value == next.value)
+                return;
+
+            if (current.state == Lattice::constant)
+                next.state = Lattice::overdefined;
+
+            current = next;
+            _value_work.push_back(out->id);
+        }
+
+        void _mark_edge(int from, int to)
+        {
+            int e = _cfg.get_edge(from, to);
+
+            if (_executable_edge[e])
+                return;
+
+            _executable_edge[e] = true;
+
+            if (!_executable_block[to])
+            {
+                _executable_block[to] = true;
+                _block_work.push_back(to);
+                return;
+            }
+
+            // a new edge into a visited block only changes its phis
+            auto& block = _cfg.get_block(to);
+
+            for (size_t i = block.begin + 1; i < block.end && _instructions[i]->get_opcode() == Instruction::PHI; i++)
+                _visit(i);
+        }
+
+        Lattice _fold_binary(Instruction::Opcode op, LlvmAtomic tp, Lattice lhs, Lattice rhs)
+        {
+            if (lhs.state == Lattice::overdefined || rhs.state == Lattice::overdefined)
+                return { Lattice::overdefined, 0 };
+
+            if (lhs.state == Lattice::unknown || rhs.state == Lattice::unknown)
+                return { Lattice::unknown, 0 };
+
+            // wrapping arithmetic, then truncated to the type
+            unsigned long a = lhs.value;
+            unsigned long b = rhs.value;
+            long result;
+
+            switch (op)
+            {
+            case Instruction::ADD:
+                result = a + b;
+                break;
+
+            case Instruction::SUB:
+                result = a - b;
+                break;
+
+            case Instruction::MUL:
+                result = a * b;
+                break;
+
+            default:
+            {
+                // division by zero and the overflowing min / -1 are left to run
+                long min = ConstantPool::normalize(tp, 1ul << (width(tp) - 1));
+
+                if (rhs.value == 0 || (lhs.value == min && rhs.value == -1))
+                    return { Lattice::overdefined, 0 };
+
+                result = lhs.value / rhs.value;
+            }
+            }
+
+            return { Lattice::constant, ConstantPool::normalize(tp, result) };
+        }
+
+        void _visit(int i)
+        {
+            auto instruction = _instructions[i].get();
+            int b = _block_of[i];
+
+            switch (instruction->get_opcode())
+            {
+            case Instruction::ADD:
+            case Instruction::SUB:
+            case Instruction::MUL:
+            case Instruction::SDIV:
+            {
+                auto operands = instruction->get_operands();
+                auto out = instruction->get_out();
+
+                if (!is_int(out->tp))
+                {
+                    _lower(out, { Lattice::overdefined, 0 });
+                    break;
+                }
+
+                _lower(out, _fold_binary(instruction->get_opcode(), out->tp, _get(*operands[0]), _get(*operands[1])));
+                break;
+            }
+
+            case Instruction::ICMP:
+            {
+                auto icmp = static_cast<ICmp*>(instruction);
+                auto operands = icmp->get_operands();
+                auto lhs = _get(*operands[0]);
+                auto rhs = _get(*operands[1]);
+
+                if (lhs.state == Lattice::overdefined || rhs.state == Lattice::overdefined)
+                    _lower(icmp->get_out(), { Lattice::overdefined, 0 });
+                else if (lhs.state == Lattice::constant && rhs.state == Lattice::constant)
+                    _lower(icmp->get_out(), { Lattice::constant, compare(icmp->get_cond(), (*operands[0])->tp, lhs.value, rhs.value) });
+
+                break;
+            }
+
+            case Instruction::ZEXT:
+            {
+                auto operand = *instruction->get_operands()[0];
+                auto in = _get(operand);
+
+                if (in.state == Lattice::constant && is_int(operand->tp))
+                    in.value = ConstantPool::normalize(instruction->get_out()->tp, as_unsigned(operand->tp, in.value));
+                else if (in.state == Lattice::constant)
+                    in.state = Lattice::overdefined;
+
+                _lower(instruction->get_out(), in);
+                break;
+            }
+
+            case Instruction::PHI:
+            {
+                auto phi = static_cast<Phi*>(instruction);
+                Lattice merged;
+
+                for (auto& branch: phi->get_branches())
+                {
+                    int from = _cfg.get_block_of(*branch.origin);
+                    int e = from < 0 ? -1 : _cfg.get_edge(from, b);
+
+                    if (e < 0 || !_executable_edge[e])
+                        continue;
+
+                    auto in = _get(branch.val);
+
+                    if (in.state == Lattice::unknown)
+                        continue;
+
+                    if (in.state == Lattice::overdefined || (merged.state == Lattice::constant && merged.value != in.value))
+                    {
+                        merged = { Lattice::overdefined, 0 };
+                        break;
+                    }
+
+                    merged = in;
+                }
+
+                if (!is_int(phi->get_out()->tp) && merged.state == Lattice::constant)
+                    merged.state = Lattice::overdefined;
+
+                _lower(phi->get_out(), merged);
+                break;
+            }
+
+            case Instruction::JUMP:
+                _mark_edge(b, _cfg.get_block_of(*static_cast<Jump*>(instruction)->get_target()));
+                break;
+
+            case Instruction::JUMPC:
+            {
+                auto jump = static_cast<JumpC*>(instruction);
+                auto condition = _get(jump->get_condition());
+                int on_true = _cfg.get_block_of(*jump->get_on_true());
+                int on_false = _cfg.get_block_of(*jump->get_on_false());
+
+                if (condition.state == Lattice::constant)
+                {
+                    _mark_edge(b, condition.value ? on_true : on_false);
+                }
+                else if (condition.state == Lattice::overdefined)
+                {
+                    _mark_edge(b, on_true);
+                    _mark_edge(b, on_false);
+                }
+
+                break;
+            }
+
+            default:
+                // loads, calls and allocas produce values nothing is known about
+                if (auto out = instruction->get_out())
+                    _lower(out, { Lattice::overdefined, 0 });
+            }
+        }
+
+        void _propagate()
+        {
+            _executable_block[0] = true;
+            _block_work.push_back(0);
+
+            while (!_block_work.empty() || !_value_work.empty())
+            {
+                while (!_value_work.empty())
+                {
+                    int id = _value_work.back();
+                    _value_work.pop_back();
+
+                    for (int u = _use_offsets[id]; u < _use_offsets[id + 1]; u++)
+                    {
+                        int i = _uses[u];
+
+                        if (_block_of[i] >= 0 && _executable_block[_block_of[i]])
+                            _visit(i);
+                    }
+                }
+
+                if (_block_work.empty())
+                    continue;
+
+                int b = _block_work.back();
+                _block_work.pop_back();
+
+                auto& block = _cfg.get_block(b);
+
+                for (size_t i = block.begin + 1; i < block.end; i++)
+                    _visit(i);
+
+                if (!_instructions[block.end - 1]->is_terminator() && b + 1 < _cfg.size())
+                    _mark_edge(b, b + 1);
+            }
+        }
+
+        int _rewrite()
+        {
+            int folded = 0;
+
+            for (int b = 0; b < _cfg.size(); b++)
+            {
+                if (_executable_block[b])
+                    continue;
+
+                auto& block = _cfg.get_block(b);
+
+                for (size_t i = block.begin; i < block.end; i++)
+                    _instructions[i].reset();
+            }
+
+            for (size_t i = 0; i < _instructions.size(); i++)
+            {
+                auto& instruction = _instructions[i];
+
+                if (!instruction)
+                    continue;
+
+                auto out = instruction->get_out();
+
+                if (out && _values[out->id].state == Lattice::constant)
+                {
+                    instruction.reset();
+                    folded++;
+                    continue;
+                }
+
+                for (auto operand: instruction->get_operands())
+                {
+                    int id = _id(*operand);
+
+                    if (id >= 0 && _def_of[id] >= 0 && _values[id].state == Lattice::constant)
+                        *operand = _constants.get_int((*operand)->tp, _values[id].value);
+                }
+
+                auto op = instruction->get_opcode();
+
+                if (op == Instruction::JUMPC)
+                {
+                    auto jump = static_cast<JumpC*>(instruction.get());
+
+                    if (auto literal = dynamic_cast<IntLiteral*>(jump->get_condition().get()))
+                    {
+                        instruction = std::make_unique<Jump>(literal->value ? jump->get_on_true() : jump->get_on_false());
+                        folded++;
+                    }
+                }
+                else if (op == Instruction::PHI)
+                {
+                    // only executable edges stay, the others come from deleted or rewritten branches
+                    int b = _block_of[i];
+                    auto& branches = static_cast<Phi*>(instruction.get())->get_branches();
+
+                    branches.erase(std::remove_if(branches.begin(), branches.end(), [&](Phi::Node& node)
+                    {
+                        int from = _cfg.get_block_of(*node.origin);
+                        int e = from < 0 ? -1 : _cfg.get_edge(from, b);
+                        return e < 0 || !_executable_edge[e];
+                    }), branches.end());
+                }
+            }
+
+            _instructions.erase(std::remove(_instructions.begin(), _instructions.end(), nullptr), _instructions.end());
+
+            return folded;
+        }
+    };
+}
+
+int irl::sccp(IrlSegment& function, ConstantPool& constants)
+{
+    if (function.instructions.empty() || function.instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    return Propagator(function, constants).run();
+}
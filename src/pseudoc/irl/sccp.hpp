@@ -0,0 +1,17 @@
+#pragma once
+
+#include <pseudoc/irl/constant-pool.hpp>
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // sparse conditional constant propagation (Wegman and Zadeck): values
+    // start unknown and only go down to constant and then to overdefined,
+    // while only the edges proven executable feed phis and open blocks.
+    // integer arithmetic, comparisons and extensions on constants fold to
+    // literals, branches on constants become jumps and the blocks no
+    // executable edge reaches are deleted. the function must be renumbered
+    // before and has to be renumbered again after. returns the number of
+    // folded values and resolved branches
+    int sccp(IrlSegment& function, ConstantPool& constants);
+}
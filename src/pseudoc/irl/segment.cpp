@@ -1,19 +1,13 @@
 #include <pseudoc/irl/segment.hpp>
-#include <iostream>
 
 using namespace irl;
 
-std::string IrlSegment::print()
+void IrlSegment::emit(Emitter& out)
 {
-    std::string res = "";
-
     for (auto& instruction: instructions)
     {
-        // res += instruction->print();
-        std::cout << instruction->print();
+        instruction->emit(out);
     }
-
-    return res;
 }
 
 // void IrlSegment::add_instruction(std::unique_ptr<Instruction> instruction)
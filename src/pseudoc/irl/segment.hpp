@@ -14,7 +14,7 @@ namespace irl
         std::shared_ptr<Value> out_value;
         std::shared_ptr<Value> out_false;
 
-        std::string print();
+        void emit(Emitter& out);
     };
 
     struct Context
@@ -22,7 +22,7 @@ namespace irl
         std::shared_ptr<Variable> continue_label;
         std::shared_ptr<Variable> break_label;
 
-        std::shared_ptr<Placeholder> ph_true = nullptr;
-        std::shared_ptr<Placeholder> ph_false = nullptr;
+        std::shared_ptr<Variable> ph_true = nullptr;
+        std::shared_ptr<Variable> ph_false = nullptr;
     };
 }
\ No newline at end of file
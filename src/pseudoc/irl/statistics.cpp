@@ -0,0 +1,25 @@
+#include <pseudoc/irl/statistics.hpp>
+
+using namespace irl;
+
+void Statistics::add(std::string_view name, long amount)
+{
+    auto it = _counters.find(name);
+
+    if (it == _counters.end())
+        _counters.emplace(name, amount);
+    else
+        it->second += amount;
+}
+
+long Statistics::get(std::string_view name) const
+{
+    auto it = _counters.find(name);
+    return it == _counters.end() ? 0 : it->second;
+}
+
+void Statistics::print(std::ostream& out) const
+{
+    for (auto& [name, value]: _counters)
+        out << value << ' ' << name << '\n';
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace irl
+{
+    // named counters the optimizer bumps as it goes, printed with --stats
+    class Statistics
+    {
+    public:
+        void add(std::string_view name, long amount = 1);
+        long get(std::string_view name) const;
+
+        void print(std::ostream& out) const;
+
+    private:
+        std::map<std::string, long, std::less<>> _counters;
+    };
+}
@@ -0,0 +1,137 @@
+#include <pseudoc/irl/tce.hpp>
+
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace irl;
+
+// the call returns its value straight away, or both are void
+static bool is_tail_call(Instruction& instruction, Instruction& next, const std::string& self)
+{
+    if (instruction.get_opcode() != Instruction::CALL || next.get_opcode() != Instruction::RET)
+        return false;
+
+    auto& call = static_cast<Call&>(instruction);
+
+    if (call.get_id() != self)
+        return false;
+
+    auto out = call.get_out();
+    auto ret = next.get_operands();
+
+    if (!out)
+        return ret.empty();
+
+    return ret.size() == 1 && ret[0]->get() == out.get();
+}
+
+int irl::tce(IrlSegment& function)
+{
+    auto& instructions = function.instructions;
+
+    if (instructions.size() < 2 || instructions.front()->get_opcode() != Instruction::DEF)
+        return 0;
+
+    auto def = static_cast<Def*>(instructions.front().get());
+    auto& params = def->get_params();
+
+    // tail calls, with the label of the block each one ends
+    std::vector<std::pair<Call*, std::shared_ptr<Variable>>> sites;
+    std::vector<bool> is_site(instructions.size(), false);
+    std::shared_ptr<Variable> block_label;
+
+    for (size_t i = 0; i + 1 < instructions.size(); i++)
+    {
+        auto& instruction = *instructions[i];
+
+        if (instruction.get_opcode() == Instruction::LABEL)
+            block_label = *instruction.get_out_slot();
+
+        if (!is_tail_call(instruction, *instructions[i + 1], def->get_id()))
+            continue;
+
+        auto call = static_cast<Call*>(&instruction);
+
+        if (call->get_operands().size() != params.size())
+            continue;
+
+        sites.push_back({ call, block_label });
+        is_site[i] = true;
+    }
+
+    if (sites.empty())
+        return 0;
+
+    // the parameters are read through the phis of the old entry from now on
+    int bound = id_bound(function);
+    std::vector<std::shared_ptr<Value>> merged(bound);
+    std::vector<std::unique_ptr<Phi>> phis;
+
+    for (auto& param: params)
+    {
+        auto out = std::make_shared<Variable>();
+        out->tp = param->tp;
+
+        merged[param->id] = out;
+        phis.push_back(std::make_unique<Phi>(out, out->tp));
+    }
+
+    for (size_t i = 1; i < instructions.size(); i++)
+    {
+        for (auto operand: instructions[i]->get_operands())
+        {
+            auto var = dynamic_cast<Variable*>(operand->get());
+
+            if (var && var->id < bound && merged[var->id])
+                *operand = merged[var->id];
+        }
+    }
+
+    auto entry = std::make_shared<Variable>();
+    entry->tp = LlvmAtomic::v;
+
+    auto header = *instructions[1]->get_out_slot();
+
+    for (size_t p = 0; p < params.size(); p++)
+    {
+        phis[p]->add_branch(params[p], entry);
+
+        for (auto& site: sites)
+            phis[p]->add_branch(*site.first->get_operands()[p], site.second);
+    }
+
+    // new entry, with the allocas so they still run once
+    std::vector<std::unique_ptr<Instruction>> rewritten;
+    rewritten.push_back(std::move(instructions[0]));
+    rewritten.push_back(std::make_unique<Label>(entry));
+
+    for (size_t i = 2; i < instructions.size() && !instructions[i - 1]->is_terminator(); i++)
+    {
+        if (instructions[i]->get_opcode() == Instruction::ALLOCA)
+            rewritten.push_back(std::move(instructions[i]));
+    }
+
+    rewritten.push_back(std::make_unique<Jump>(header));
+    rewritten.push_back(std::move(instructions[1]));
+
+    for (auto& phi: phis)
+        rewritten.push_back(std::move(phi));
+
+    for (size_t i = 2; i < instructions.size(); i++)
+    {
+        if (!instructions[i])
+            continue;
+
+        if (is_site[i])
+        {
+            // the ret after it goes too
+            rewritten.push_back(std::make_unique<Jump>(header));
+            i++;
+            continue;
+        }
+
+        rewritten.push_back(std::move(instructions[i]));
+    }
+
+    instructions = std::move(rewritten);
+    return sites.size();
+}
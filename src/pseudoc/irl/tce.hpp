@@ -0,0 +1,16 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+
+namespace irl
+{
+    // tail call elimination: a call of the function to itself whose result
+    // is returned right away becomes a jump back to the entry, so the
+    // recursion runs as a loop in a single frame. the entry block is moved
+    // under a new one holding the allocas, and phis there take the
+    // parameters on the first pass and the arguments of each tail call on
+    // the others. the function must be in ssa form (after mem2reg) and
+    // renumbered before, and has to be renumbered again after. returns the
+    // number of eliminated calls
+    int tce(IrlSegment& function);
+}
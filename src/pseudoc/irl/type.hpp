@@ -1,6 +1,6 @@
 #pragma once
 
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace irl
@@ -18,11 +18,47 @@ namespace irl
         b
     };
 
-    std::string atomic_to_string(LlvmAtomic a);
+    struct AtomicInfo
+    {
+        std::string_view name;
+        short size;
+        short alignment;
+    };
+
+    // indexed by LlvmAtomic
+    constexpr AtomicInfo atomic_table[] =
+    {
+        { "<error>", 0, 0 },
+        { "void", 0, 0 },
+        { "i8", 1, 1 },
+        { "i16", 2, 2 },
+        { "i32", 4, 4 },
+        { "i64", 8, 8 },
+        { "float", 4, 4 },
+        { "double", 8, 8 },
+        { "i1", 1, 1 }
+    };
+
+    static_assert(sizeof(atomic_table) / sizeof(atomic_table[0]) == LlvmAtomic::b + 1, "atomic_table must cover every LlvmAtomic");
+
+    constexpr std::string_view atomic_to_string(LlvmAtomic a)
+    {
+        return atomic_table[a].name;
+    }
+
+    constexpr short atomic_size(LlvmAtomic a)
+    {
+        return atomic_table[a].size;
+    }
+
+    constexpr short atomic_alignment(LlvmAtomic a)
+    {
+        return atomic_table[a].alignment;
+    }
 
     struct FunctionDef
     {
         LlvmAtomic tp;
         std::vector<LlvmAtomic> params;
     };
-}
\ No newline at end of file
+}
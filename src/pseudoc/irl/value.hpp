@@ -1,27 +1,45 @@
 #pragma once
 
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
 #include <string>
 
+#include <pseudoc/irl/emitter.hpp>
 #include <pseudoc/irl/type.hpp>
 
 namespace irl
 {
+    // writes the decimal digits of value at buf (at least 20 chars long), returning the end
+    inline char* format_int(char* buf, long value)
+    {
+        return std::to_chars(buf, buf + 20, value).ptr;
+    }
+
     struct Value
     {
         virtual ~Value() = default;
 
         LlvmAtomic tp;
 
-        virtual std::string print() = 0;
+        virtual void emit(Emitter& out) = 0;
     };
 
+    // temporaries and labels are plain numbers assigned by irl::renumber
+    // once the function is finished, the %N text is only rendered when the
+    // instruction is emitted
     struct Variable : public Value
     {
-        std::string id;
+        int id = -1;
 
-        virtual std::string print() override
+        virtual void emit(Emitter& out) override
         {
-            return id;
+            if (id < 0)
+                throw std::logic_error("temporary was not numbered");
+
+            out << '%' << id;
         }
     };
 
@@ -29,33 +47,25 @@ namespace irl
     {
         long value;
 
-        std::string print() override
+        void emit(Emitter& out) override
         {
-            return std::to_string(value);
+            out << value;
         }
     };
 
-    struct Placeholder : public Variable
+    struct FloatLiteral : public Value
     {
-        Placeholder()
-        {
-            id = "";
-        }
-
-        void fix_id(std::string id)
-        {
-            if (this->id != "")
-                throw std::logic_error("id was already fixed");
-
-            this->id = id;
-        }
+        double value;
 
-        std::string print() override
+        void emit(Emitter& out) override
         {
-            if (this->id == "")
-                throw std::logic_error("id was not fixed");
+            // llvm expects the hex form of the double for both float and double
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
 
-            return id;
+            char buf[19];
+            std::snprintf(buf, sizeof(buf), "0x%016" PRIX64, bits);
+            out << std::string_view(buf, 18);
         }
     };
-}
\ No newline at end of file
+}
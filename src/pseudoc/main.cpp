@@ -1,50 +1,208 @@
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <unistd.h>
+#include <vector>
 
+#include <pseudoc/irl/emitter.hpp>
+#include <pseudoc/irl/inliner.hpp>
+#include <pseudoc/irl/interpreter.hpp>
+#include <pseudoc/irl/optimizer.hpp>
+#include <pseudoc/irl/renumber.hpp>
 #include <pseudoc/lexer.hpp>
 #include <pseudoc/parser.hpp>
+#include <pseudoc/x86/backend.hpp>
+#include <pseudoc/x86/jit.hpp>
 
 int main(int argc, char **argv)
 {
     // TODO use a lib
-    if (argc != 2)
+    std::string source;
+    std::string output;
+    bool print_ast = false;
+    bool print_stats = false;
+    bool fold_ast = false;
+    bool emit_asm = false;
+    bool emit_object = false;
+    bool run = false;
+    bool interpret = false;
+    int opt_level = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else if (arg == "--print-ast")
+            print_ast = true;
+        else if (arg == "--stats")
+            print_stats = true;
+        else if (arg == "--fold-ast")
+            fold_ast = true;
+        else if (arg == "-S")
+            emit_asm = true;
+        else if (arg == "-c")
+            emit_object = true;
+        else if (arg == "--run")
+            run = true;
+        else if (arg == "--interpret")
+            interpret = true;
+        else if (arg.size() == 3 && arg.compare(0, 2, "-O") == 0 && arg[2] >= '0' && arg[2] <= '2')
+            opt_level = arg[2] - '0';
+        else if (source.empty())
+            source = arg;
+        else
+            source = "";
+    }
+
+    if (source.empty())
     {
-        std::cout << "usage:" << std::endl << "pseudoc <source-file>" << std::endl;
+        std::cout << "usage:" << std::endl << "pseudoc <source-file> [-o <output-file>] [-O0|-O1|-O2] [-S|-c|--run|--interpret] [--print-ast] [--fold-ast] [--stats]" << std::endl;
         return EXIT_FAILURE;
     }
 
-    std::ifstream ifs(argv[1]);
+    std::ifstream ifs(source);
 
     if (!ifs.is_open())
     {
-        std::cout << "could not open source file\"" << argv[1] << std::endl;
+        std::cout << "could not open source file\"" << source << std::endl;
         return EXIT_FAILURE;
     }
 
     std::string src((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
     Lexer lexer(src);
     auto ftable = std::make_shared<FunctionTable>();
+    auto constants = std::make_shared<irl::ConstantPool>();
 
     irl::Context base_context;
     base_context.break_label = nullptr;
     base_context.continue_label = nullptr;
 
+    std::vector<std::unique_ptr<ast::Definition>> definitions;
+
+    // optimized builds fold constant subtrees while parsing
+    set_constant_folding(opt_level >= 1);
+
     while (!lexer.is_eof())
     {
-        auto ast = parse_definition(lexer);
-        auto scope = std::make_shared<VariableScope>();
+        definitions.push_back(parse_definition(lexer));
+    }
+
+    if (fold_ast)
+    {
+        for (auto& ast: definitions)
+            ast->fold_constants();
+    }
+
+    // declaration pass, every signature is known before any body is generated
+    for (auto& ast: definitions)
+    {
+        ast->set_variable_scope(std::make_shared<VariableScope>(constants), ftable);
+        ast->declare_function();
+    }
 
-        std::cout << "Definition:" << std::endl;
-        std::cout << ast->print() << std::endl << std::endl;
+    std::vector<std::unique_ptr<irl::IrlSegment>> module;
+    irl::Statistics stats;
 
-        std::cout << "Code Gen" << std::endl;
+    for (auto& ast: definitions)
+    {
+        if (print_ast)
+            std::cout << ast->print() << std::endl;
 
-        ast->set_variable_scope(scope, ftable);
         auto segment = ast->code_gen(base_context);
+        irl::renumber(*segment);
+        irl::optimize(*segment, *constants, opt_level, stats);
+
+        module.push_back(std::move(segment));
+    }
+
+    // -O2 also inlines across the module, once every function is optimized
+    if (opt_level >= 2)
+        irl::inline_functions(module, *ftable, *constants, opt_level, stats);
+
+    std::cout.flush();
+
+    // runs main in this process, its result is the exit status
+    if (run || interpret)
+    {
+        int status;
+
+        if (run)
+        {
+            x86::Jit jit(ftable, opt_level);
+            jit.add(module);
 
-        std::cout << segment->print() << std::endl << std::endl;
+            auto entry = jit.get_function<int()>("main");
+
+            if (!entry)
+            {
+                std::cout << "no main function to run" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            status = entry();
+        }
+        else
+        {
+            irl::Interpreter interpreter(module);
+
+            if (!interpreter.has_function("main"))
+            {
+                std::cout << "no main function to run" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            status = interpreter.call("main", {});
+        }
+
+        if (print_stats)
+            stats.print(std::cerr);
+
+        return status;
+    }
+
+    // opened only now, so --run and --interpret leave an existing file alone
+    int fd = STDOUT_FILENO;
+
+    if (!output.empty())
+    {
+        fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (fd < 0)
+        {
+            std::cout << "could not open output file\"" << output << std::endl;
+            return EXIT_FAILURE;
+        }
     }
 
+    irl::Emitter out(fd);
+
+    if (emit_object)
+    {
+        x86::emit_object(module, out, opt_level);
+    }
+    else if (emit_asm)
+    {
+        x86::emit_assembly(module, out, opt_level);
+    }
+    else
+    {
+        for (auto& segment: module)
+        {
+            segment->emit(out);
+            out << '\n';
+        }
+    }
+
+    out.flush();
+
+    if (fd != STDOUT_FILENO)
+        close(fd);
+
+    if (print_stats)
+        stats.print(std::cerr);
+
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -7,4 +7,8 @@ irl::LlvmAtomic parse_type(Lexer& lexer);
 std::unique_ptr<ast::Expression> parse_expression(Lexer& lexer);
 std::unique_ptr<ast::Statement> parse_statement(Lexer& lexer);
 std::unique_ptr<ast::CompoundStatement> parse_compound_statement(Lexer& lexer);
-std::unique_ptr<ast::Definition> parse_definition(Lexer& lexer);
\ No newline at end of file
+std::unique_ptr<ast::Definition> parse_definition(Lexer& lexer);
+
+// fold-on-construct: every expression node is folded as soon as it is built
+void set_constant_folding(bool enabled);
+std::unique_ptr<ast::Expression> build_expression(std::unique_ptr<ast::Expression> expr);
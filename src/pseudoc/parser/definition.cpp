@@ -86,6 +86,14 @@ std::unique_ptr<ast::Definition> parse_definition(Lexer& lexer)
 
     auto id = curr.lexema;
     auto params = parse_param_declaration_list(lexer);
+
+    // prototype
+    if (lexer.peek_current().tk_type == ';')
+    {
+        lexer.bump();
+        return std::make_unique<ast::FunctionDeclaration>(std::move(id), tp, std::move(params));
+    }
+
     auto body = parse_compound_statement(lexer);
 
     return std::make_unique<ast::FunctionDefinition>(std::move(id), tp, std::move(params), std::move(body));
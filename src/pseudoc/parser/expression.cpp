@@ -2,6 +2,25 @@
 
 #include <iostream>
 
+static bool constant_folding = false;
+
+void set_constant_folding(bool enabled)
+{
+    constant_folding = enabled;
+}
+
+std::unique_ptr<ast::Expression> build_expression(std::unique_ptr<ast::Expression> expr)
+{
+    // the children were folded when they were built, only the node itself is left
+    if (constant_folding)
+    {
+        if (auto folded = expr->fold())
+            return folded;
+    }
+
+    return expr;
+}
+
 std::unique_ptr<ast::Expression> parse_primary_expression(Lexer& lexer)
 {
     auto curr = lexer.bump();
@@ -110,7 +129,7 @@ std::unique_ptr<ast::Expression> parse_multiplicative_expression_r(Lexer& lexer,
     {
         lexer.bump();
         auto rhs = parse_increment_expression(lexer);
-        auto expr = std::make_unique<ast::Multiplication>(std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Multiplication>(std::move(lhs), std::move(rhs)));
 
         return parse_multiplicative_expression_r(lexer, std::move(expr));
     }
@@ -119,7 +138,7 @@ std::unique_ptr<ast::Expression> parse_multiplicative_expression_r(Lexer& lexer,
     {
         lexer.bump();
         auto rhs = parse_increment_expression(lexer);
-        auto expr = std::make_unique<ast::Division>(std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Division>(std::move(lhs), std::move(rhs)));
 
         return parse_multiplicative_expression_r(lexer, std::move(expr));
     }
@@ -161,7 +180,7 @@ std::unique_ptr<ast::Expression> parse_additive_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_multiplicative_expression(lexer);
-        auto expr = std::make_unique<ast::Addition>(std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Addition>(std::move(lhs), std::move(rhs)));
 
         return parse_additive_expression_r(lexer, std::move(expr));
     }
@@ -170,7 +189,7 @@ std::unique_ptr<ast::Expression> parse_additive_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_multiplicative_expression(lexer);
-        auto expr = std::make_unique<ast::Subtraction>(std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Subtraction>(std::move(lhs), std::move(rhs)));
 
         return parse_additive_expression_r(lexer, std::move(expr));
     }
@@ -209,7 +228,7 @@ std::unique_ptr<ast::Expression> parse_equality_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_additive_expression(lexer);
-        auto expr = std::make_unique<ast::Compare>(ast::Compare::Code::EQ, std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Compare>(ast::Compare::Code::EQ, std::move(lhs), std::move(rhs)));
 
         return parse_equality_expression_r(lexer, std::move(expr));
     }
@@ -218,7 +237,7 @@ std::unique_ptr<ast::Expression> parse_equality_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_additive_expression(lexer);
-        auto expr = std::make_unique<ast::Compare>(ast::Compare::Code::NE, std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Compare>(ast::Compare::Code::NE, std::move(lhs), std::move(rhs)));
 
         return parse_equality_expression_r(lexer, std::move(expr));
     }
@@ -227,7 +246,7 @@ std::unique_ptr<ast::Expression> parse_equality_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_additive_expression(lexer);
-        auto expr = std::make_unique<ast::Compare>(ast::Compare::Code::LT, std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Compare>(ast::Compare::Code::LT, std::move(lhs), std::move(rhs)));
 
         return parse_equality_expression_r(lexer, std::move(expr));
     }
@@ -236,7 +255,7 @@ std::unique_ptr<ast::Expression> parse_equality_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_additive_expression(lexer);
-        auto expr = std::make_unique<ast::Compare>(ast::Compare::Code::LE, std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Compare>(ast::Compare::Code::LE, std::move(lhs), std::move(rhs)));
 
         return parse_equality_expression_r(lexer, std::move(expr));
     }
@@ -245,7 +264,7 @@ std::unique_ptr<ast::Expression> parse_equality_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_additive_expression(lexer);
-        auto expr = std::make_unique<ast::Compare>(ast::Compare::Code::GT, std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Compare>(ast::Compare::Code::GT, std::move(lhs), std::move(rhs)));
 
         return parse_equality_expression_r(lexer, std::move(expr));
     }
@@ -254,7 +273,7 @@ std::unique_ptr<ast::Expression> parse_equality_expression_r(Lexer& lexer, std::
     {
         lexer.bump();
         auto rhs = parse_additive_expression(lexer);
-        auto expr = std::make_unique<ast::Compare>(ast::Compare::Code::GE, std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::Compare>(ast::Compare::Code::GE, std::move(lhs), std::move(rhs)));
 
         return parse_equality_expression_r(lexer, std::move(expr));
     }
@@ -291,12 +310,12 @@ std::unique_ptr<ast::Expression> parse_logical_and_expression_r(Lexer& lexer, st
         auto rhs = parse_equality_expression(lexer);
 
         if (lhs->get_type() != irl::LlvmAtomic::b)
-            lhs = std::make_unique<ast::BooleanCast>(std::move(lhs));
+            lhs = build_expression(std::make_unique<ast::BooleanCast>(std::move(lhs)));
 
         if (rhs->get_type() != irl::LlvmAtomic::b)
-            rhs = std::make_unique<ast::BooleanCast>(std::move(rhs));
+            rhs = build_expression(std::make_unique<ast::BooleanCast>(std::move(rhs)));
 
-        auto expr = std::make_unique<ast::LogicalAnd>(std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::LogicalAnd>(std::move(lhs), std::move(rhs)));
 
         return parse_logical_and_expression_r(lexer, std::move(expr));
     }
@@ -330,12 +349,12 @@ std::unique_ptr<ast::Expression> parse_logical_or_expression_r(Lexer& lexer, std
         auto rhs = parse_logical_and_expression(lexer);
 
         if (lhs->get_type() != irl::LlvmAtomic::b)
-            lhs = std::make_unique<ast::BooleanCast>(std::move(lhs));
+            lhs = build_expression(std::make_unique<ast::BooleanCast>(std::move(lhs)));
 
         if (rhs->get_type() != irl::LlvmAtomic::b)
-            rhs = std::make_unique<ast::BooleanCast>(std::move(rhs));
+            rhs = build_expression(std::make_unique<ast::BooleanCast>(std::move(rhs)));
 
-        auto expr = std::make_unique<ast::LogicalOr>(std::move(lhs), std::move(rhs));
+        auto expr = build_expression(std::make_unique<ast::LogicalOr>(std::move(lhs), std::move(rhs)));
 
         return parse_logical_or_expression_r(lexer, std::move(expr));
     }
@@ -378,7 +397,7 @@ std::unique_ptr<ast::Expression> parse_conditional_expression(Lexer& lexer)
 
         auto false_branch = parse_conditional_expression(lexer);
 
-        return std::make_unique<ast::ConditionalExpression>(std::move(condition), std::move(true_branch), std::move(false_branch));
+        return build_expression(std::make_unique<ast::ConditionalExpression>(std::move(condition), std::move(true_branch), std::move(false_branch)));
     }
 
     if (curr.tk_type == ';' || curr.tk_type == ')' || curr.tk_type == ',' || curr.tk_type == '?' || curr.tk_type == ':')
@@ -96,7 +96,7 @@ std::unique_ptr<ast::Statement> parse_if_statement(Lexer& lexer)
 
     if (condition->get_type() != irl::LlvmAtomic::b)
     {
-        condition = std::make_unique<ast::BooleanCast>(std::move(condition));
+        condition = build_expression(std::make_unique<ast::BooleanCast>(std::move(condition)));
     }
 
     curr = lexer.bump();
@@ -130,7 +130,7 @@ std::unique_ptr<ast::Statement> parse_while_loop(Lexer& lexer)
 
     if (condition->get_type() != irl::LlvmAtomic::b)
     {
-        condition = std::make_unique<ast::BooleanCast>(std::move(condition));
+        condition = build_expression(std::make_unique<ast::BooleanCast>(std::move(condition)));
     }
 
     curr = lexer.bump();
@@ -164,7 +164,7 @@ std::unique_ptr<ast::Statement> parse_for_loop(Lexer& lexer)
 
     if (condition->get_type() != irl::LlvmAtomic::b)
     {
-        condition = std::make_unique<ast::BooleanCast>(std::move(condition));
+        condition = build_expression(std::make_unique<ast::BooleanCast>(std::move(condition)));
     }
 
     auto increment = parse_expression(lexer);
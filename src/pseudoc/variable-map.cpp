@@ -1,93 +1,147 @@
 #include <pseudoc/variable-map.hpp>
 
-VariableScope::VariableScope()
+VariableScope::VariableScope(std::shared_ptr<irl::ConstantPool> constants):
+    _constants(std::move(constants))
 {
-    _name_gen = std::make_shared<IrlNameGenerator>();
 }
 
-VariableScope::VariableScope(std::shared_ptr<VariableScope> parent):
-    _parent(std::move(parent)),
-    _name_gen(parent->_name_gen)
+int VariableScope::intern(const std::string& id)
 {
-    int a = 3 + 9;
+    auto it = _symbols.find(id);
+
+    if (it != _symbols.end())
+        return it->second;
+
+    int symbol = _names.size();
+
+    _symbols[id] = symbol;
+    _names.push_back(id);
+    _table.push_back({ nullptr, 0 });
+
+    return symbol;
 }
 
-std::shared_ptr<irl::Variable> VariableScope::add_variable(std::string id, irl::LlvmAtomic tp)
+void VariableScope::push_block()
 {
-    // verifies redeclaration on the current scope
-    // it should be possible to correctly override the parent scope
-    if (!_variables.empty())
-    {
-        auto it = _variables.find(id);
+    _blocks.push_back(_shadowed.size());
+}
 
-        if (it != _variables.end())
-            throw std::logic_error("variable " + id + " redeclared");
+void VariableScope::pop_block()
+{
+    if (_blocks.empty())
+        throw std::logic_error("no block to close");
+
+    auto mark = _blocks.back();
+    _blocks.pop_back();
+
+    while (_shadowed.size() > mark)
+    {
+        auto& shadow = _shadowed.back();
+        _table[shadow.symbol] = std::move(shadow.previous);
+        _shadowed.pop_back();
     }
+}
+
+std::shared_ptr<irl::Variable> VariableScope::add_variable(int symbol, irl::LlvmAtomic tp)
+{
+    // verifies redeclaration on the current block
+    // it should be possible to correctly override the outer blocks
+    int depth = _blocks.size();
+    auto& binding = _table[symbol];
+
+    if (binding.var && binding.depth == depth)
+        throw std::logic_error("variable " + _names[symbol] + " redeclared");
+
+    _shadowed.push_back({ symbol, std::move(binding) });
 
     auto var = new_temp(tp);
-    _variables[id] = var;
+    binding = { var, depth };
 
     return var;
 }
 
-std::shared_ptr<irl::Variable> VariableScope::get_variable(const std::string& id)
+std::shared_ptr<irl::Variable> VariableScope::get_variable(int symbol)
 {
-    auto it = _variables.find(id);
+    auto& binding = _table[symbol];
 
-    if (it == _variables.end())
-    {
-        if (_parent)
-            return _parent->get_variable(id);
-
-        throw std::logic_error("reference to undeclared variable " + id);
-    }
+    if (!binding.var)
+        throw std::logic_error("reference to undeclared variable " + _names[symbol]);
 
-    return it->second;
+    return binding.var;
 }
 
 std::shared_ptr<irl::Variable> VariableScope::new_temp(irl::LlvmAtomic tp)
 {
     auto var = std::make_shared<irl::Variable>();
-    var->id = '\%' + _name_gen->get_next();
     var->tp = tp;
 
     return var;
 }
 
-void VariableScope::skip()
+std::shared_ptr<irl::ConstantPool> VariableScope::get_constants()
 {
-    _name_gen->get_next();
+    return _constants;
 }
 
-std::shared_ptr<irl::Placeholder> VariableScope::new_placeholder(irl::LlvmAtomic tp)
+bool FunctionTable::declare_function(const std::string& id, irl::FunctionDef def)
 {
-    return std::make_shared<irl::Placeholder>();
+    auto it = _functions.find(id);
+
+    if (it == _functions.end())
+    {
+        _functions[id] = { std::move(def), false, nullptr };
+        return true;
+    }
+
+    auto& prev = it->second.def;
+
+    if (prev.tp != def.tp || prev.params != def.params)
+        throw std::logic_error("conflicting types for function " + id);
+
+    return false;
 }
 
-void VariableScope::fix_placehoder(std::shared_ptr<irl::Placeholder> placeholder)
+void FunctionTable::define_function(const std::string& id)
 {
-    placeholder->fix_id('\%' + _name_gen->get_next());
+    auto it = _functions.find(id);
+
+    if (it == _functions.end())
+        throw std::logic_error("definition of undeclared function " + id);
+
+    if (it->second.defined)
+        throw std::logic_error("redefinition of function " + id);
+
+    it->second.defined = true;
 }
 
-void FunctionTable::add_function(std::string id, irl::FunctionDef def)
+irl::FunctionDef FunctionTable::get_function(const std::string& id) const
 {
-    if (!_functions.empty())
-    {
-        auto it = _functions.find(id);
+    auto it = _functions.find(id);
 
-        if (it != _functions.end())
-            throw std::logic_error("redefinition of function " + id);
-    }
+    if (it == _functions.end())
+        throw std::logic_error("reference to undeclared function " + id);
+
+    return it->second.def;
+}
 
-    _functions[id] = def;
+bool FunctionTable::is_defined(const std::string& id) const
+{
+    auto it = _functions.find(id);
+    return it != _functions.end() && it->second.defined;
 }
 
-irl::FunctionDef FunctionTable::get_function(const std::string& id)
+void FunctionTable::set_address(const std::string& id, void* address)
 {
     auto it = _functions.find(id);
 
     if (it == _functions.end())
-        throw std::logic_error("reference to undeclared function " + id);
+        throw std::logic_error("address of undeclared function " + id);
 
-    return it->second;
-}
\ No newline at end of file
+    it->second.address = address;
+}
+
+void* FunctionTable::get_address(const std::string& id) const
+{
+    auto it = _functions.find(id);
+    return it == _functions.end() ? nullptr : it->second.address;
+}
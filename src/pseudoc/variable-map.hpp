@@ -5,50 +5,82 @@
 #include <vector>
 #include <unordered_map>
 
+#include <pseudoc/irl/constant-pool.hpp>
 #include <pseudoc/irl/type.hpp>
 #include <pseudoc/irl/value.hpp>
 
-class IrlNameGenerator
+// a single symbol indexed table for the whole function: identifiers are
+// interned to symbol indices when the ast is bound, declaring pushes the
+// previous binding on a shadow stack and leaving a block pops it back, so
+// both lookup and declaration are O(1) regardless of the nesting depth
+class VariableScope
 {
 public:
-    auto get_next()
-    {
-        return std::to_string(_current++);
-    }
+    VariableScope(std::shared_ptr<irl::ConstantPool> constants);
 
-private:
-    int _current = 0;
-};
+    int intern(const std::string& id);
 
-class VariableScope
-{
-public:
-    VariableScope();
-    VariableScope(std::shared_ptr<VariableScope> parent);
+    void push_block();
+    void pop_block();
 
-    std::shared_ptr<irl::Variable> add_variable(std::string id, irl::LlvmAtomic tp);
-    std::shared_ptr<irl::Variable> get_variable(const std::string& id);
+    std::shared_ptr<irl::Variable> add_variable(int symbol, irl::LlvmAtomic tp);
+    std::shared_ptr<irl::Variable> get_variable(int symbol);
 
+    // temporaries and labels are created unnumbered, irl::renumber names them
     std::shared_ptr<irl::Variable> new_temp(irl::LlvmAtomic tp);
-    void skip();
-
-    std::shared_ptr<irl::Placeholder> new_placeholder(irl::LlvmAtomic tp);
-    void fix_placehoder(std::shared_ptr<irl::Placeholder> placeholder);
 
-protected:
-    std::shared_ptr<IrlNameGenerator> _name_gen;
+    std::shared_ptr<irl::ConstantPool> get_constants();
 
 private:
-    std::shared_ptr<VariableScope> _parent;
-    std::unordered_map<std::string, std::shared_ptr<irl::Variable>> _variables;
+    struct Binding
+    {
+        std::shared_ptr<irl::Variable> var;
+        int depth;
+    };
+
+    struct Shadow
+    {
+        int symbol;
+        Binding previous;
+    };
+
+    std::shared_ptr<irl::ConstantPool> _constants;
+
+    std::unordered_map<std::string, int> _symbols;
+    std::vector<std::string> _names;
+
+    // current binding of each symbol
+    std::vector<Binding> _table;
+    std::vector<Shadow> _shadowed;
+
+    // size of _shadowed when each open block was entered
+    std::vector<size_t> _blocks;
 };
 
+// signatures of every function in the module, filled by the declaration
+// pass before any body is generated; the jit then records the address of
+// each function it compiles
 class FunctionTable
 {
 public:
-    void add_function(std::string id, irl::FunctionDef def);
-    irl::FunctionDef get_function(const std::string& id);
+    // true for the first declaration of id, later ones only check the signature
+    bool declare_function(const std::string& id, irl::FunctionDef def);
+    void define_function(const std::string& id);
+
+    irl::FunctionDef get_function(const std::string& id) const;
+    bool is_defined(const std::string& id) const;
+
+    // entry point of the function once compiled into this process, null before
+    void set_address(const std::string& id, void* address);
+    void* get_address(const std::string& id) const;
 
 private:
-    std::unordered_map<std::string, irl::FunctionDef> _functions;
+    struct Entry
+    {
+        irl::FunctionDef def;
+        bool defined;
+        void* address = nullptr;
+    };
+
+    std::unordered_map<std::string, Entry> _functions;
 };
\ No newline at end of file
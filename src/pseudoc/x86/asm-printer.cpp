@@ -0,0 +1,177 @@
+#include <pseudoc/x86/asm-printer.hpp>
+
+using namespace x86;
+
+namespace
+{
+    constexpr std::string_view cond_names[] =
+    {
+        "o", "no", "b", "ae", "e", "ne", "be", "a", "s", "ns", "p", "np", "l", "ge", "le", "g"
+    };
+
+    char suffix(int size)
+    {
+        return size == 1 ? 'b' : size == 4 ? 'l' : 'q';
+    }
+
+    void print_operand(const Operand& operand, int size, irl::Emitter& out)
+    {
+        switch (operand.kind)
+        {
+        case Operand::reg:
+            out << '%' << reg_name(operand.base, size);
+            break;
+
+        case Operand::imm:
+            out << '$' << static_cast<long>(operand.value);
+            break;
+
+        case Operand::mem:
+            if (operand.value)
+                out << static_cast<long>(operand.value);
+
+            out << "(%" << reg_name(operand.base, 8) << ')';
+            break;
+
+        default:
+            out << "<virtual>";
+            break;
+        }
+    }
+
+    void print_label(const Code& code, int block, irl::Emitter& out)
+    {
+        out << ".L" << code.name << '.' << block;
+    }
+
+    // op{suffix} src, dst
+    void print_binary(std::string_view name, const Inst& inst, irl::Emitter& out)
+    {
+        out << '\t' << name << suffix(inst.size) << ' ';
+        print_operand(inst.src, inst.size, out);
+        out << ", ";
+        print_operand(inst.dst, inst.size, out);
+        out << '\n';
+    }
+
+    void print_unary(std::string_view name, const Inst& inst, irl::Emitter& out)
+    {
+        out << '\t' << name << suffix(inst.size) << ' ';
+        print_operand(inst.dst, inst.size, out);
+        out << '\n';
+    }
+}
+
+void x86::print_assembly(const Code& code, irl::Emitter& out)
+{
+    out << "\t.globl " << code.name << '\n';
+    out << "\t.type " << code.name << ", @function\n";
+    out << code.name << ":\n";
+
+    for (auto& inst: code.insts)
+    {
+        switch (inst.op)
+        {
+        case Inst::LABEL:
+            print_label(code, inst.label, out);
+            out << ":\n";
+            break;
+
+        case Inst::MOV:
+            if (inst.src.kind == Operand::imm && inst.src.value != static_cast<int32_t>(inst.src.value))
+                print_binary("movabs", inst, out);
+            else
+                print_binary("mov", inst, out);
+
+            break;
+
+        case Inst::MOVZX:
+            out << "\tmovzb" << suffix(inst.size) << ' ';
+            print_operand(inst.src, 1, out);
+            out << ", ";
+            print_operand(inst.dst, inst.size, out);
+            out << '\n';
+            break;
+
+        case Inst::LEA:
+            print_binary("lea", inst, out);
+            break;
+
+        case Inst::ADD:
+            print_binary("add", inst, out);
+            break;
+
+        case Inst::SUB:
+            print_binary("sub", inst, out);
+            break;
+
+        case Inst::IMUL:
+            if (inst.imm.kind != Operand::imm)
+            {
+                print_binary("imul", inst, out);
+                break;
+            }
+
+            out << "\timul" << suffix(inst.size) << ' ';
+            print_operand(inst.imm, inst.size, out);
+            out << ", ";
+            print_operand(inst.src, inst.size, out);
+            out << ", ";
+            print_operand(inst.dst, inst.size, out);
+            out << '\n';
+            break;
+
+        case Inst::CDQ:
+            out << (inst.size == 8 ? "\tcqto\n" : "\tcltd\n");
+            break;
+
+        case Inst::IDIV:
+            print_unary("idiv", inst, out);
+            break;
+
+        case Inst::CMP:
+            print_binary("cmp", inst, out);
+            break;
+
+        case Inst::TEST:
+            print_binary("test", inst, out);
+            break;
+
+        case Inst::SETCC:
+            out << "\tset" << cond_names[inst.cc] << ' ';
+            print_operand(inst.dst, 1, out);
+            out << '\n';
+            break;
+
+        case Inst::JCC:
+            out << "\tj" << cond_names[inst.cc] << ' ';
+            print_label(code, inst.label, out);
+            out << '\n';
+            break;
+
+        case Inst::JMP:
+            out << "\tjmp ";
+            print_label(code, inst.label, out);
+            out << '\n';
+            break;
+
+        case Inst::CALL:
+            out << "\tcall " << code.symbols[inst.symbol] << "@PLT\n";
+            break;
+
+        case Inst::RET:
+            out << "\tret\n";
+            break;
+
+        case Inst::PUSH:
+            print_unary("push", inst, out);
+            break;
+
+        case Inst::POP:
+            print_unary("pop", inst, out);
+            break;
+        }
+    }
+
+    out << "\t.size " << code.name << ", .-" << code.name << '\n';
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <pseudoc/irl/emitter.hpp>
+#include <pseudoc/x86/code.hpp>
+
+namespace x86
+{
+    // writes the function as GNU assembler text, in AT&T syntax
+    void print_assembly(const Code& code, irl::Emitter& out);
+}
@@ -0,0 +1,57 @@
+#include <pseudoc/x86/backend.hpp>
+
+#include <pseudoc/x86/asm-printer.hpp>
+#include <pseudoc/x86/elf-writer.hpp>
+#include <pseudoc/x86/encoder.hpp>
+#include <pseudoc/x86/expand.hpp>
+#include <pseudoc/x86/graph-coloring.hpp>
+#include <pseudoc/x86/isel.hpp>
+#include <pseudoc/x86/linear-scan.hpp>
+
+using namespace x86;
+
+namespace
+{
+    // declarations name functions defined elsewhere, the linker resolves them
+    bool is_definition(irl::IrlSegment& segment)
+    {
+        return !segment.instructions.empty() && segment.instructions.front()->get_opcode() == irl::Instruction::DEF;
+    }
+}
+
+Code x86::compile(irl::IrlSegment& function, int level)
+{
+    auto machine = select(function);
+    auto allocation = level >= 2 ? allocate_graph_coloring(machine) : allocate_linear_scan(machine);
+
+    return expand(machine, allocation);
+}
+
+void x86::emit_assembly(std::vector<std::unique_ptr<irl::IrlSegment>>& module, irl::Emitter& out, int level)
+{
+    out << "\t.text\n";
+
+    for (auto& segment: module)
+    {
+        if (!is_definition(*segment))
+            continue;
+
+        out << '\n';
+        print_assembly(compile(*segment, level), out);
+    }
+
+    out << "\n\t.section .note.GNU-stack,\"\",@progbits\n";
+}
+
+void x86::emit_object(std::vector<std::unique_ptr<irl::IrlSegment>>& module, irl::Emitter& out, int level)
+{
+    std::vector<MachineCode> functions;
+
+    for (auto& segment: module)
+    {
+        if (is_definition(*segment))
+            functions.push_back(encode(compile(*segment, level)));
+    }
+
+    write_object(functions, out);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <pseudoc/irl/emitter.hpp>
+#include <pseudoc/irl/segment.hpp>
+#include <pseudoc/x86/code.hpp>
+
+namespace x86
+{
+    // compiles a function segment (Def ... EndDef), renumbered, down to x86-64.
+    // from level 2 on the registers are allocated by graph coloring instead
+    // of linear scan, slower to compile but with fewer copies and spills
+    Code compile(irl::IrlSegment& function, int level = 0);
+
+    // the defined functions of the module as a GNU assembler file
+    void emit_assembly(std::vector<std::unique_ptr<irl::IrlSegment>>& module, irl::Emitter& out, int level = 0);
+
+    // the defined functions of the module as an ELF64 relocatable object
+    void emit_object(std::vector<std::unique_ptr<irl::IrlSegment>>& module, irl::Emitter& out, int level = 0);
+}
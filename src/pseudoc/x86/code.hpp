@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <pseudoc/x86/machine.hpp>
+
+namespace x86
+{
+    // concrete x86-64 instruction over registers, immediates and rbp or
+    // rsp based memory, the destination first like in the intel manuals
+    struct Inst
+    {
+        enum Op : char
+        {
+            // start of block label
+            LABEL,
+
+            MOV,
+
+            // dst (4 bytes) = zero extended low byte of src
+            MOVZX,
+
+            LEA,
+            ADD,
+            SUB,
+
+            // three operand form when imm is set
+            IMUL,
+
+            // sign extends eax (rax) into edx (rdx)
+            CDQ,
+
+            IDIV,
+            CMP,
+            TEST,
+            SETCC,
+            JCC,
+            JMP,
+            CALL,
+            RET,
+            PUSH,
+            POP
+        };
+
+        Op op;
+
+        // operand size in bytes
+        char size = 4;
+
+        Cond cc = e;
+        Operand dst;
+        Operand src;
+        Operand imm;
+
+        // block of a LABEL, JCC or JMP
+        int label = -1;
+
+        // callee of a CALL, index on Code::symbols
+        int symbol = -1;
+    };
+
+    struct Code
+    {
+        std::string name;
+        std::vector<Inst> insts;
+        std::vector<std::string> symbols;
+    };
+}
@@ -0,0 +1,202 @@
+#include <pseudoc/x86/elf-writer.hpp>
+
+#include <cstring>
+#include <elf.h>
+#include <string>
+#include <unordered_map>
+
+using namespace x86;
+
+namespace
+{
+    enum Section
+    {
+        null_section,
+        text,
+        rela_text,
+        symtab,
+        strtab,
+        shstrtab,
+        note_gnu_stack,
+        section_count
+    };
+
+    // string table under construction, offset 0 is the empty string
+    class StringTable
+    {
+    public:
+        StringTable():
+            _data(1, '\0')
+        {
+        }
+
+        Elf64_Word add(const std::string& text)
+        {
+            Elf64_Word offset = _data.size();
+            _data.append(text);
+            _data.push_back('\0');
+            return offset;
+        }
+
+        const std::string& get_data() const
+        {
+            return _data;
+        }
+
+    private:
+        std::string _data;
+    };
+
+    template <typename T>
+    void append(std::string& out, const T& value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void align(std::string& out, size_t alignment, char fill = '\0')
+    {
+        out.resize((out.size() + alignment - 1) / alignment * alignment, fill);
+    }
+}
+
+void x86::write_object(const std::vector<MachineCode>& functions, irl::Emitter& out)
+{
+    // .text, functions 16 byte aligned and padded with int3
+    std::string code;
+    std::vector<size_t> starts;
+
+    for (auto& function: functions)
+    {
+        align(code, 16, '\xcc');
+        starts.push_back(code.size());
+        code.append(reinterpret_cast<const char*>(function.bytes.data()), function.bytes.size());
+    }
+
+    // the null symbol, then every function and the undefined callees, all global
+    StringTable names;
+    std::vector<Elf64_Sym> symbols(1);
+    std::unordered_map<std::string, Elf64_Word> symbol_of;
+
+    for (size_t i = 0; i < functions.size(); i++)
+    {
+        Elf64_Sym symbol {};
+        symbol.st_name = names.add(functions[i].name);
+        symbol.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+        symbol.st_shndx = text;
+        symbol.st_value = starts[i];
+        symbol.st_size = functions[i].bytes.size();
+
+        symbol_of[functions[i].name] = symbols.size();
+        symbols.push_back(symbol);
+    }
+
+    std::vector<Elf64_Rela> relocations;
+
+    for (size_t i = 0; i < functions.size(); i++)
+    {
+        for (auto& call: functions[i].calls)
+        {
+            auto& callee = functions[i].symbols[call.symbol];
+            auto it = symbol_of.find(callee);
+
+            if (it == symbol_of.end())
+            {
+                Elf64_Sym symbol {};
+                symbol.st_name = names.add(callee);
+                symbol.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+                symbol.st_shndx = SHN_UNDEF;
+
+                it = symbol_of.emplace(callee, symbols.size()).first;
+                symbols.push_back(symbol);
+            }
+
+            // the displacement is taken from the end of the rel32 field
+            Elf64_Rela relocation {};
+            relocation.r_offset = starts[i] + call.offset;
+            relocation.r_info = ELF64_R_INFO(it->second, R_X86_64_PLT32);
+            relocation.r_addend = -4;
+            relocations.push_back(relocation);
+        }
+    }
+
+    StringTable section_names;
+    Elf64_Shdr headers[section_count] {};
+
+    std::string file(sizeof(Elf64_Ehdr), '\0');
+
+    auto place = [&](Section section, const char* name, Elf64_Word type, size_t alignment, const std::string& data)
+    {
+        align(file, alignment);
+
+        auto& header = headers[section];
+        header.sh_name = section_names.add(name);
+        header.sh_type = type;
+        header.sh_offset = file.size();
+        header.sh_size = data.size();
+        header.sh_addralign = alignment;
+
+        file.append(data);
+    };
+
+    place(text, ".text", SHT_PROGBITS, 16, code);
+    headers[text].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+
+    std::string rela_data;
+
+    for (auto& relocation: relocations)
+        append(rela_data, relocation);
+
+    place(rela_text, ".rela.text", SHT_RELA, 8, rela_data);
+    headers[rela_text].sh_flags = SHF_INFO_LINK;
+    headers[rela_text].sh_link = symtab;
+    headers[rela_text].sh_info = text;
+    headers[rela_text].sh_entsize = sizeof(Elf64_Rela);
+
+    std::string symbol_data;
+
+    for (auto& symbol: symbols)
+        append(symbol_data, symbol);
+
+    place(symtab, ".symtab", SHT_SYMTAB, 8, symbol_data);
+    headers[symtab].sh_link = strtab;
+    headers[symtab].sh_entsize = sizeof(Elf64_Sym);
+
+    // index of the first global symbol, only the null symbol is local
+    headers[symtab].sh_info = 1;
+
+    place(strtab, ".strtab", SHT_STRTAB, 1, names.get_data());
+    place(note_gnu_stack, ".note.GNU-stack", SHT_PROGBITS, 1, "");
+
+    // named last, so its own name is in the data it holds
+    auto shstrtab_name = section_names.add(".shstrtab");
+    headers[shstrtab].sh_name = shstrtab_name;
+    headers[shstrtab].sh_type = SHT_STRTAB;
+    headers[shstrtab].sh_offset = file.size();
+    headers[shstrtab].sh_size = section_names.get_data().size();
+    headers[shstrtab].sh_addralign = 1;
+    file.append(section_names.get_data());
+
+    align(file, 8);
+    size_t section_offset = file.size();
+
+    for (auto& header: headers)
+        append(file, header);
+
+    Elf64_Ehdr elf {};
+    std::memcpy(elf.e_ident, ELFMAG, SELFMAG);
+    elf.e_ident[EI_CLASS] = ELFCLASS64;
+    elf.e_ident[EI_DATA] = ELFDATA2LSB;
+    elf.e_ident[EI_VERSION] = EV_CURRENT;
+    elf.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    elf.e_type = ET_REL;
+    elf.e_machine = EM_X86_64;
+    elf.e_version = EV_CURRENT;
+    elf.e_shoff = section_offset;
+    elf.e_ehsize = sizeof(Elf64_Ehdr);
+    elf.e_shentsize = sizeof(Elf64_Shdr);
+    elf.e_shnum = section_count;
+    elf.e_shstrndx = shstrtab;
+    std::memcpy(file.data(), &elf, sizeof(elf));
+
+    out << std::string_view(file);
+}
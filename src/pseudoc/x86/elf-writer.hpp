@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+
+#include <pseudoc/irl/emitter.hpp>
+#include <pseudoc/x86/encoder.hpp>
+
+namespace x86
+{
+    // writes an ELF64 relocatable object with the functions in .text, each
+    // a global symbol, and R_X86_64_PLT32 relocations for their calls. the
+    // callees not among the functions are left undefined for the linker
+    void write_object(const std::vector<MachineCode>& functions, irl::Emitter& out);
+}
@@ -0,0 +1,393 @@
+#include <pseudoc/x86/encoder.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+
+using namespace x86;
+
+namespace
+{
+    bool fits_imm8(int64_t value)
+    {
+        return value == static_cast<int8_t>(value);
+    }
+
+    bool fits_imm32(int64_t value)
+    {
+        return value == static_cast<int32_t>(value);
+    }
+
+    // appends the bytes of one instruction
+    class Writer
+    {
+    public:
+        Writer(std::vector<uint8_t>& out):
+            _out(out)
+        {
+        }
+
+        void byte(int value)
+        {
+            _out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void imm(int64_t value, int size)
+        {
+            for (int i = 0; i < size; i++)
+                byte(value >> (8 * i));
+        }
+
+        // rex prefix, when needed. byte_rm tells rm is accessed as a byte,
+        // and spl to dil can only be named with a rex
+        void prefix(int size, int reg, const Operand& rm, bool byte_rm = false)
+        {
+            int rex = 0;
+
+            if (size == 8)
+                rex |= 8;
+
+            if (reg >= 8)
+                rex |= 4;
+
+            if (rm.kind != Operand::none && rm.base >= 8)
+                rex |= 1;
+
+            if (rex || (byte_rm && rm.kind == Operand::reg && rm.base >= rsp && rm.base <= rdi))
+                byte(0x40 | rex);
+        }
+
+        // modrm, sib and displacement for reg (or an opcode extension) and rm
+        void modrm(int reg, const Operand& rm)
+        {
+            reg &= 7;
+
+            if (rm.kind == Operand::reg)
+            {
+                byte(0xc0 | reg << 3 | (rm.base & 7));
+                return;
+            }
+
+            int base = rm.base & 7;
+            int64_t disp = rm.value;
+            int mod = disp == 0 && base != rbp ? 0 : fits_imm8(disp) ? 1 : 2;
+
+            byte(mod << 6 | reg << 3 | base);
+
+            // rsp and r12 as a base need a sib byte without index
+            if (base == rsp)
+                byte(0x24);
+
+            if (mod == 1)
+                imm(disp, 1);
+            else if (mod == 2)
+                imm(disp, 4);
+        }
+
+        // prefix, opcode and modrm of an instruction with a reg and an r/m operand
+        void op(int size, std::initializer_list<int> opcode, int reg, const Operand& rm, bool byte_rm = false)
+        {
+            prefix(size, reg, rm, byte_rm);
+
+            for (int part: opcode)
+                byte(part);
+
+            modrm(reg, rm);
+        }
+
+    private:
+        std::vector<uint8_t>& _out;
+    };
+
+    // add, sub and cmp share their encodings up to the opcode extension
+    struct AluOpcodes
+    {
+        int rm_reg;
+        int reg_rm;
+        int digit;
+    };
+
+    void encode_alu(Writer& out, const AluOpcodes& opcodes, const Inst& inst)
+    {
+        if (inst.src.kind == Operand::imm)
+        {
+            if (fits_imm8(inst.src.value))
+            {
+                out.op(inst.size, { 0x83 }, opcodes.digit, inst.dst);
+                out.imm(inst.src.value, 1);
+                return;
+            }
+
+            out.op(inst.size, { 0x81 }, opcodes.digit, inst.dst);
+            out.imm(inst.src.value, 4);
+            return;
+        }
+
+        if (inst.src.kind == Operand::reg)
+            out.op(inst.size, { opcodes.rm_reg }, inst.src.base, inst.dst);
+        else
+            out.op(inst.size, { opcodes.reg_rm }, inst.dst.base, inst.src);
+    }
+
+    void encode_mov(Writer& out, const Inst& inst)
+    {
+        if (inst.src.kind != Operand::imm)
+        {
+            if (inst.src.kind == Operand::reg)
+                out.op(inst.size, { 0x89 }, inst.src.base, inst.dst);
+            else
+                out.op(inst.size, { 0x8b }, inst.dst.base, inst.src);
+
+            return;
+        }
+
+        int64_t value = inst.src.value;
+
+        if (inst.dst.kind == Operand::reg && (inst.size == 4 || (value >= 0 && value <= UINT32_MAX)))
+        {
+            // 32 bit writes clear the upper half, so this also covers
+            // small positive 64 bit values
+            out.prefix(4, 0, inst.dst);
+            out.byte(0xb8 + (inst.dst.base & 7));
+            out.imm(value, 4);
+        }
+        else if (inst.dst.kind == Operand::reg && !fits_imm32(value))
+        {
+            out.prefix(8, 0, inst.dst);
+            out.byte(0xb8 + (inst.dst.base & 7));
+            out.imm(value, 8);
+        }
+        else
+        {
+            out.op(inst.size, { 0xc7 }, 0, inst.dst);
+            out.imm(value, 4);
+        }
+    }
+
+    // every instruction but the jumps, whose size is not settled yet
+    void encode_fixed(Writer& out, const Inst& inst, std::vector<uint8_t>& bytes, MachineCode& code)
+    {
+        switch (inst.op)
+        {
+        case Inst::MOV:
+            encode_mov(out, inst);
+            break;
+
+        case Inst::MOVZX:
+            out.op(inst.size, { 0x0f, 0xb6 }, inst.dst.base, inst.src, true);
+            break;
+
+        case Inst::LEA:
+            out.op(inst.size, { 0x8d }, inst.dst.base, inst.src);
+            break;
+
+        case Inst::ADD:
+            encode_alu(out, { 0x01, 0x03, 0 }, inst);
+            break;
+
+        case Inst::SUB:
+            encode_alu(out, { 0x29, 0x2b, 5 }, inst);
+            break;
+
+        case Inst::CMP:
+            encode_alu(out, { 0x39, 0x3b, 7 }, inst);
+            break;
+
+        case Inst::TEST:
+            out.op(inst.size, { 0x85 }, inst.src.base, inst.dst);
+            break;
+
+        case Inst::IMUL:
+        {
+            // imul $imm, %reg is the three operand form reading the destination
+            Operand source = inst.src.kind == Operand::imm ? inst.dst : inst.src;
+            Operand factor = inst.src.kind == Operand::imm ? inst.src : inst.imm;
+
+            if (factor.kind != Operand::imm)
+            {
+                out.op(inst.size, { 0x0f, 0xaf }, inst.dst.base, source);
+            }
+            else if (fits_imm8(factor.value))
+            {
+                out.op(inst.size, { 0x6b }, inst.dst.base, source);
+                out.imm(factor.value, 1);
+            }
+            else
+            {
+                out.op(inst.size, { 0x69 }, inst.dst.base, source);
+                out.imm(factor.value, 4);
+            }
+
+            break;
+        }
+
+        case Inst::CDQ:
+            out.prefix(inst.size, 0, {});
+            out.byte(0x99);
+            break;
+
+        case Inst::IDIV:
+            out.op(inst.size, { 0xf7 }, 7, inst.dst);
+            break;
+
+        case Inst::SETCC:
+            out.op(1, { 0x0f, 0x90 + inst.cc }, 0, inst.dst, true);
+            break;
+
+        case Inst::CALL:
+            out.byte(0xe8);
+            code.calls.push_back({ bytes.size(), inst.symbol });
+            out.imm(0, 4);
+            break;
+
+        case Inst::RET:
+            out.byte(0xc3);
+            break;
+
+        case Inst::PUSH:
+            if (inst.dst.kind == Operand::reg)
+            {
+                out.prefix(4, 0, inst.dst);
+                out.byte(0x50 + (inst.dst.base & 7));
+            }
+            else if (inst.dst.kind == Operand::imm && fits_imm8(inst.dst.value))
+            {
+                out.byte(0x6a);
+                out.imm(inst.dst.value, 1);
+            }
+            else if (inst.dst.kind == Operand::imm)
+            {
+                out.byte(0x68);
+                out.imm(inst.dst.value, 4);
+            }
+            else
+            {
+                out.op(4, { 0xff }, 6, inst.dst);
+            }
+
+            break;
+
+        case Inst::POP:
+            out.prefix(4, 0, inst.dst);
+            out.byte(0x58 + (inst.dst.base & 7));
+            break;
+
+        default:
+            throw std::logic_error("x86 encoder: unexpected instruction");
+        }
+    }
+}
+
+MachineCode x86::encode(const Code& code)
+{
+    MachineCode machine;
+    machine.name = code.name;
+    machine.symbols = code.symbols;
+
+    auto& insts = code.insts;
+    int labels = 0;
+
+    for (auto& inst: insts)
+    {
+        if (inst.op == Inst::LABEL)
+            labels = std::max(labels, inst.label + 1);
+    }
+
+    // sizes of the jumps, grown until every displacement fits
+    std::vector<bool> is_long(insts.size());
+    std::vector<size_t> offsets(insts.size() + 1);
+    std::vector<size_t> label_offsets(labels);
+    std::vector<uint8_t> scratch;
+    std::vector<size_t> fixed_sizes(insts.size());
+
+    for (size_t i = 0; i < insts.size(); i++)
+    {
+        if (insts[i].op == Inst::LABEL || insts[i].op == Inst::JMP || insts[i].op == Inst::JCC)
+            continue;
+
+        MachineCode ignored;
+        scratch.clear();
+        Writer writer(scratch);
+        encode_fixed(writer, insts[i], scratch, ignored);
+        fixed_sizes[i] = scratch.size();
+    }
+
+    auto jump_size = [&](size_t i)
+    {
+        if (!is_long[i])
+            return 2;
+
+        return insts[i].op == Inst::JMP ? 5 : 6;
+    };
+
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (size_t i = 0; i < insts.size(); i++)
+        {
+            auto& inst = insts[i];
+
+            if (inst.op == Inst::LABEL)
+                label_offsets[inst.label] = offsets[i];
+
+            bool jump = inst.op == Inst::JMP || inst.op == Inst::JCC;
+            offsets[i + 1] = offsets[i] + (jump ? jump_size(i) : fixed_sizes[i]);
+        }
+
+        for (size_t i = 0; i < insts.size(); i++)
+        {
+            if ((insts[i].op != Inst::JMP && insts[i].op != Inst::JCC) || is_long[i])
+                continue;
+
+            int64_t disp = static_cast<int64_t>(label_offsets[insts[i].label]) - static_cast<int64_t>(offsets[i + 1]);
+
+            if (!fits_imm8(disp))
+            {
+                is_long[i] = true;
+                changed = true;
+            }
+        }
+    }
+
+    auto& bytes = machine.bytes;
+    bytes.reserve(offsets.back());
+    Writer writer(bytes);
+
+    for (size_t i = 0; i < insts.size(); i++)
+    {
+        auto& inst = insts[i];
+
+        if (inst.op == Inst::LABEL)
+            continue;
+
+        if (inst.op != Inst::JMP && inst.op != Inst::JCC)
+        {
+            encode_fixed(writer, inst, bytes, machine);
+            continue;
+        }
+
+        int64_t disp = static_cast<int64_t>(label_offsets[inst.label]) - static_cast<int64_t>(offsets[i + 1]);
+
+        if (!is_long[i])
+        {
+            writer.byte(inst.op == Inst::JMP ? 0xeb : 0x70 + inst.cc);
+            writer.imm(disp, 1);
+        }
+        else if (inst.op == Inst::JMP)
+        {
+            writer.byte(0xe9);
+            writer.imm(disp, 4);
+        }
+        else
+        {
+            writer.byte(0x0f);
+            writer.byte(0x80 + inst.cc);
+            writer.imm(disp, 4);
+        }
+    }
+
+    return machine;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pseudoc/x86/code.hpp>
+
+namespace x86
+{
+    // call whose target is only known once the code is linked
+    struct CallSite
+    {
+        // position of the rel32 field, relative to the start of the function
+        size_t offset;
+
+        // index on MachineCode::symbols
+        int symbol;
+    };
+
+    struct MachineCode
+    {
+        std::string name;
+        std::vector<uint8_t> bytes;
+        std::vector<CallSite> calls;
+        std::vector<std::string> symbols;
+    };
+
+    // encodes the function into machine code. jumps start short and only
+    // grow to rel32 when their target is out of reach, and call targets
+    // are left as zeroed rel32 fields listed on MachineCode::calls
+    MachineCode encode(const Code& code);
+}
@@ -0,0 +1,445 @@
+#include <pseudoc/x86/expand.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace x86;
+
+namespace
+{
+    bool fits_imm32(int64_t value)
+    {
+        return value == static_cast<int32_t>(value);
+    }
+
+    // condition holding with the operands of the compare swapped
+    Cond swap_operands(Cond cc)
+    {
+        switch (cc)
+        {
+        case l:
+            return g;
+
+        case g:
+            return l;
+
+        case le:
+            return ge;
+
+        case ge:
+            return le;
+
+        case b:
+            return a;
+
+        case a:
+            return b;
+
+        case be:
+            return ae;
+
+        case ae:
+            return be;
+
+        default:
+            return cc;
+        }
+    }
+
+    class Expander
+    {
+    public:
+        Expander(const MachineFunction& function, const Allocation& allocation):
+            _function(function),
+            _allocation(allocation)
+        {
+            _code.name = function.name;
+            _code.symbols = function.symbols;
+            _saved_size = 8 * allocation.callee_saved.size();
+        }
+
+        Code run()
+        {
+            _prologue();
+
+            for (size_t b = 0; b < _function.blocks.size(); b++)
+            {
+                _next_block = b + 1;
+                _emit({ Inst::LABEL, 4, e, {}, {}, {}, static_cast<int>(b), -1 });
+
+                for (auto& inst: _function.blocks[b].insts)
+                    _expand(inst);
+            }
+
+            return std::move(_code);
+        }
+
+    private:
+        const MachineFunction& _function;
+        const Allocation& _allocation;
+        Code _code;
+
+        // bytes of callee saved registers pushed below the saved rbp
+        int _saved_size;
+
+        int _next_block;
+
+        static constexpr Operand _rax = { Operand::reg, rax };
+        static constexpr Operand _r11 = { Operand::reg, r11 };
+
+        void _emit(Inst inst)
+        {
+            _code.insts.push_back(inst);
+        }
+
+        void _emit(Inst::Op op, int size, Operand dst, Operand src = {})
+        {
+            _emit({ op, static_cast<char>(size), e, dst, src, {}, -1, -1 });
+        }
+
+        Operand _location(const Operand& operand)
+        {
+            switch (operand.kind)
+            {
+            case Operand::vreg:
+            {
+                auto& location = _allocation.locations[operand.value];
+
+                if (location.slot < 0)
+                    return Operand::make_reg(location.reg);
+
+                return _slot(location.slot);
+            }
+
+            case Operand::slot:
+                return _slot(operand.value);
+
+            default:
+                return operand;
+            }
+        }
+
+        Operand _slot(int slot)
+        {
+            return Operand::make_mem(rbp, -_saved_size - 8 * (slot + 1));
+        }
+
+        void _move(int size, Operand dst, Operand src)
+        {
+            if (dst == src)
+                return;
+
+            if (dst.kind == Operand::mem && (src.kind == Operand::mem || (src.kind == Operand::imm && !fits_imm32(src.value))))
+            {
+                _emit(Inst::MOV, size, _r11, src);
+                src = _r11;
+            }
+
+            _emit(Inst::MOV, size, dst, src);
+        }
+
+        // the operand itself when it is a register, else a copy in scratch
+        Operand _in_reg(int size, Operand operand, Operand scratch)
+        {
+            if (operand.kind == Operand::reg)
+                return operand;
+
+            _move(size, scratch, operand);
+            return scratch;
+        }
+
+        // operand usable as the source of an alu instruction
+        Operand _alu_source(int size, Operand operand)
+        {
+            if (operand.kind == Operand::imm && !fits_imm32(operand.value))
+                return _in_reg(size, operand, _rax);
+
+            return operand;
+        }
+
+        void _prologue()
+        {
+            Operand rbp_reg = Operand::make_reg(rbp);
+            Operand rsp_reg = Operand::make_reg(rsp);
+
+            _emit(Inst::PUSH, 8, rbp_reg);
+            _emit(Inst::MOV, 8, rbp_reg, rsp_reg);
+
+            for (Reg reg: _allocation.callee_saved)
+                _emit(Inst::PUSH, 8, Operand::make_reg(reg));
+
+            // the return address and rbp leave rsp aligned, keep it so for calls
+            int frame = 8 * (_function.slots + _allocation.spill_slots);
+
+            if ((_saved_size + frame) % 16)
+                frame += 8;
+
+            if (frame)
+                _emit(Inst::SUB, 8, rsp_reg, Operand::make_imm(frame));
+        }
+
+        void _epilogue()
+        {
+            Operand rbp_reg = Operand::make_reg(rbp);
+            Operand rsp_reg = Operand::make_reg(rsp);
+
+            if (_saved_size)
+                _emit(Inst::LEA, 8, rsp_reg, Operand::make_mem(rbp, -_saved_size));
+            else
+                _emit(Inst::MOV, 8, rsp_reg, rbp_reg);
+
+            for (auto it = _allocation.callee_saved.rbegin(); it != _allocation.callee_saved.rend(); it++)
+                _emit(Inst::POP, 8, Operand::make_reg(*it));
+
+            _emit(Inst::POP, 8, rbp_reg);
+            _emit(Inst::RET, 8, {});
+        }
+
+        // every dst = src at once, cycles are broken through rax
+        void _parallel_move(std::vector<std::pair<Operand, Operand>> moves)
+        {
+            moves.erase(std::remove_if(moves.begin(), moves.end(), [](auto& move) { return move.first == move.second; }), moves.end());
+
+            while (!moves.empty())
+            {
+                size_t ready = 0;
+
+                for (; ready < moves.size(); ready++)
+                {
+                    bool read = false;
+
+                    for (size_t other = 0; other < moves.size() && !read; other++)
+                        read = other != ready && moves[other].second == moves[ready].first;
+
+                    if (!read)
+                        break;
+                }
+
+                if (ready < moves.size())
+                {
+                    _move(8, moves[ready].first, moves[ready].second);
+                    moves.erase(moves.begin() + ready);
+                    continue;
+                }
+
+                Operand blocked = moves.front().first;
+                _move(8, _rax, blocked);
+
+                for (auto& move: moves)
+                {
+                    if (move.second == blocked)
+                        move.second = _rax;
+                }
+            }
+        }
+
+        void _binary(Inst::Op op, int size, Operand dst, Operand lhs, Operand rhs)
+        {
+            rhs = _alu_source(size, rhs);
+
+            if (op == Inst::IMUL && rhs.kind == Operand::imm)
+            {
+                Operand target = dst.kind == Operand::reg ? dst : _r11;
+
+                if (lhs.kind == Operand::imm)
+                    lhs = _in_reg(size, lhs, target);
+
+                _emit({ Inst::IMUL, static_cast<char>(size), e, target, lhs, rhs, -1, -1 });
+                _move(size, dst, target);
+                return;
+            }
+
+            if (op != Inst::SUB && dst == rhs)
+                std::swap(lhs, rhs);
+
+            // computed in place when dst is a register not read as rhs
+            Operand target = dst.kind == Operand::reg && dst != rhs ? dst : _r11;
+
+            _move(size, target, lhs);
+            _emit(op, size, target, rhs);
+            _move(size, dst, target);
+        }
+
+        // compare setting the flags for cc, which may get swapped
+        Cond _compare(int size, Operand lhs, Operand rhs, Cond cc)
+        {
+            if (lhs.kind == Operand::imm && rhs.kind != Operand::imm)
+            {
+                std::swap(lhs, rhs);
+                cc = swap_operands(cc);
+            }
+
+            if (lhs.kind == Operand::imm || (lhs.kind == Operand::mem && rhs.kind == Operand::mem))
+                lhs = _in_reg(size, lhs, _r11);
+
+            _emit(Inst::CMP, size, lhs, _alu_source(size, rhs));
+            return cc;
+        }
+
+        void _jump(int block)
+        {
+            if (block != _next_block)
+                _emit({ Inst::JMP, 4, e, {}, {}, {}, block, -1 });
+        }
+
+        // conditional jump to on_true, falling through where possible
+        void _branch(Cond cc, int on_true, int on_false)
+        {
+            if (on_true == _next_block)
+            {
+                _emit({ Inst::JCC, 4, negate(cc), {}, {}, {}, on_false, -1 });
+                return;
+            }
+
+            _emit({ Inst::JCC, 4, cc, {}, {}, {}, on_true, -1 });
+            _jump(on_false);
+        }
+
+        void _call(const MInst& inst)
+        {
+            int args = inst.uses.size();
+            int stack_args = std::max(0, args - static_cast<int>(std::size(arg_regs)));
+            int pad = stack_args % 2 ? 8 : 0;
+            Operand rsp_reg = Operand::make_reg(rsp);
+
+            if (pad)
+                _emit(Inst::SUB, 8, rsp_reg, Operand::make_imm(pad));
+
+            for (int i = args - 1; i >= static_cast<int>(std::size(arg_regs)); i--)
+                _emit(Inst::PUSH, 8, _alu_source(8, _location(inst.uses[i])));
+
+            std::vector<std::pair<Operand, Operand>> moves;
+
+            for (int i = 0; i < args && i < static_cast<int>(std::size(arg_regs)); i++)
+                moves.emplace_back(Operand::make_reg(arg_regs[i]), _location(inst.uses[i]));
+
+            _parallel_move(std::move(moves));
+            _emit({ Inst::CALL, 8, e, {}, {}, {}, -1, inst.symbol });
+
+            if (stack_args)
+                _emit(Inst::ADD, 8, rsp_reg, Operand::make_imm(8 * stack_args + pad));
+
+            if (!inst.defs.empty())
+                _move(inst.wide ? 8 : 4, _location(inst.defs[0]), _rax);
+        }
+
+        void _expand(const MInst& inst)
+        {
+            int size = inst.wide ? 8 : 4;
+
+            switch (inst.op)
+            {
+            case MInst::MOV:
+                _move(size, _location(inst.defs[0]), _location(inst.uses[0]));
+                break;
+
+            case MInst::ZEXT:
+            {
+                // 32 bit writes clear the upper half of the register
+                Operand dst = _location(inst.defs[0]);
+
+                if (dst.kind == Operand::reg || !inst.wide)
+                {
+                    _move(4, dst, _location(inst.uses[0]));
+                    break;
+                }
+
+                _move(4, _r11, _location(inst.uses[0]));
+                _move(8, dst, _r11);
+                break;
+            }
+
+            case MInst::ADD:
+            case MInst::SUB:
+            case MInst::IMUL:
+            {
+                static constexpr Inst::Op ops[] = { Inst::ADD, Inst::SUB, Inst::IMUL };
+
+                _binary(ops[inst.op - MInst::ADD], size, _location(inst.defs[0]), _location(inst.uses[0]), _location(inst.uses[1]));
+                break;
+            }
+
+            case MInst::SDIV:
+            {
+                _move(size, _rax, _location(inst.uses[0]));
+                _emit(Inst::CDQ, size, {});
+
+                Operand divisor = _location(inst.uses[1]);
+
+                if (divisor.kind == Operand::imm)
+                    divisor = _in_reg(size, divisor, _r11);
+
+                _emit(Inst::IDIV, size, divisor);
+                _move(size, _location(inst.defs[0]), _rax);
+                break;
+            }
+
+            case MInst::SETCC:
+            {
+                Cond cc = _compare(size, _location(inst.uses[0]), _location(inst.uses[1]), inst.cc);
+                Operand dst = _location(inst.defs[0]);
+                Operand target = dst.kind == Operand::reg ? dst : _r11;
+
+                _emit({ Inst::SETCC, 1, cc, _r11, {}, {}, -1, -1 });
+                _emit(Inst::MOVZX, 4, target, _r11);
+                _move(4, dst, target);
+                break;
+            }
+
+            case MInst::CMP_JUMP:
+            {
+                Cond cc = _compare(size, _location(inst.uses[0]), _location(inst.uses[1]), inst.cc);
+                _branch(cc, inst.targets[0], inst.targets[1]);
+                break;
+            }
+
+            case MInst::TEST_JUMP:
+            {
+                Operand condition = _location(inst.uses[0]);
+
+                if (condition.kind == Operand::reg)
+                    _emit(Inst::TEST, 4, condition, condition);
+                else
+                    _emit(Inst::CMP, 4, condition, Operand::make_imm(0));
+
+                _branch(ne, inst.targets[0], inst.targets[1]);
+                break;
+            }
+
+            case MInst::JMP:
+                _jump(inst.targets[0]);
+                break;
+
+            case MInst::RET:
+                if (!inst.uses.empty())
+                    _move(size, _rax, _location(inst.uses[0]));
+
+                _epilogue();
+                break;
+
+            case MInst::CALL:
+                _call(inst);
+                break;
+
+            case MInst::PMOVE:
+            {
+                std::vector<std::pair<Operand, Operand>> moves;
+
+                for (size_t i = 0; i < inst.defs.size(); i++)
+                    moves.emplace_back(_location(inst.defs[i]), _location(inst.uses[i]));
+
+                _parallel_move(std::move(moves));
+                break;
+            }
+
+            default:
+                throw std::logic_error("x86 backend: unknown machine instruction");
+            }
+        }
+    };
+}
+
+Code x86::expand(const MachineFunction& function, const Allocation& allocation)
+{
+    return Expander(function, allocation).run();
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <pseudoc/x86/code.hpp>
+
+namespace x86
+{
+    // rewrites the machine function with its registers allocated into
+    // concrete instructions: frame setup, operand shapes x86 accepts (with
+    // rax and r11 as scratch), parallel moves ordered and calls laid out
+    // following the System V ABI
+    Code expand(const MachineFunction& function, const Allocation& allocation);
+}
@@ -0,0 +1,702 @@
+#include <pseudoc/x86/graph-coloring.hpp>
+
+#include <climits>
+#include <cmath>
+#include <unordered_set>
+
+using namespace x86;
+
+namespace
+{
+    constexpr int K = std::size(allocatable_regs);
+
+    // interference queries go to a bit matrix while it stays small, and to
+    // a hash set of the edges for the large functions
+    class AdjacencySet
+    {
+    public:
+        AdjacencySet(int nodes):
+            _nodes(nodes),
+            _dense(nodes <= dense_limit)
+        {
+            if (_dense)
+                _matrix.resize((static_cast<size_t>(nodes) * nodes + 63) / 64);
+        }
+
+        bool contains(int u, int v) const
+        {
+            if (_dense)
+            {
+                size_t bit = static_cast<size_t>(u) * _nodes + v;
+                return _matrix[bit / 64] >> (bit % 64) & 1;
+            }
+
+            return _edges.count(_key(u, v)) > 0;
+        }
+
+        void add(int u, int v)
+        {
+            if (_dense)
+            {
+                size_t uv = static_cast<size_t>(u) * _nodes + v;
+                size_t vu = static_cast<size_t>(v) * _nodes + u;
+
+                _matrix[uv / 64] |= 1ull << (uv % 64);
+                _matrix[vu / 64] |= 1ull << (vu % 64);
+                return;
+            }
+
+            _edges.insert(_key(u, v));
+        }
+
+    private:
+        // 4096 nodes take 2 MiB as a matrix
+        static constexpr int dense_limit = 4096;
+
+        int _nodes;
+        bool _dense;
+        std::vector<uint64_t> _matrix;
+        std::unordered_set<uint64_t> _edges;
+
+        static uint64_t _key(int u, int v)
+        {
+            if (u > v)
+                std::swap(u, v);
+
+            return static_cast<uint64_t>(u) << 32 | static_cast<uint32_t>(v);
+        }
+    };
+
+    // nodes 0 to K - 1 are the allocatable registers, node K + v is vreg v.
+    // every node is in exactly one of the sets below, worklists are vectors
+    // whose stale entries (of nodes that have moved on) are skipped
+    class Coloring
+    {
+    public:
+        Coloring(const MachineFunction& function):
+            _function(function),
+            _nodes(K + function.vregs),
+            _adj_set(_nodes),
+            _adj_list(_nodes),
+            _degree(_nodes, 0),
+            _move_list(_nodes),
+            _alias(_nodes),
+            _color(_nodes, -1),
+            _set(_nodes, initial),
+            _cost(_nodes, 0),
+            _mark(_nodes, 0)
+        {
+            for (int r = 0; r < K; r++)
+            {
+                _set[r] = precolored;
+                _color[r] = r;
+                _degree[r] = INT_MAX / 2;
+            }
+
+            for (int n = 0; n < _nodes; n++)
+                _alias[n] = n;
+        }
+
+        Allocation run()
+        {
+            _build();
+            _make_worklist();
+
+            while (true)
+            {
+                int node;
+
+                if ((node = _pop(_simplify_worklist, simplify)) >= 0)
+                    _simplify(node);
+                else if (_coalesce())
+                    continue;
+                else if ((node = _pop(_freeze_worklist, freeze)) >= 0)
+                    _freeze(node);
+                else if (!_select_spill())
+                    break;
+            }
+
+            return _assign_colors();
+        }
+
+    private:
+        enum Set : char
+        {
+            precolored,
+            initial,
+            simplify,
+            freeze,
+            spill,
+            spilled,
+            coalesced,
+            colored,
+            on_stack,
+
+            // registers the function never uses
+            unused
+        };
+
+        enum MoveState : char
+        {
+            worklist_move,
+            active_move,
+            coalesced_move,
+            constrained_move,
+            frozen_move
+        };
+
+        struct Move
+        {
+            int dst;
+            int src;
+            MoveState state;
+        };
+
+        const MachineFunction& _function;
+        int _nodes;
+
+        AdjacencySet _adj_set;
+        std::vector<std::vector<int>> _adj_list;
+        std::vector<int> _degree;
+        std::vector<std::vector<int>> _move_list;
+        std::vector<int> _alias;
+        std::vector<int> _color;
+        std::vector<Set> _set;
+        std::vector<double> _cost;
+
+        std::vector<Move> _moves;
+        std::vector<int> _move_worklist;
+
+        std::vector<int> _simplify_worklist;
+        std::vector<int> _freeze_worklist;
+        std::vector<int> _spill_worklist;
+        std::vector<int> _select_stack;
+
+        // scratch marks to take unions of adjacency lists
+        std::vector<int> _mark;
+        int _generation = 0;
+
+        static int _node(const Operand& operand)
+        {
+            if (operand.kind == Operand::vreg)
+                return K + operand.value;
+
+            if (operand.kind == Operand::reg)
+            {
+                for (int r = 0; r < K; r++)
+                {
+                    if (allocatable_regs[r] == operand.base)
+                        return r;
+                }
+            }
+
+            return -1;
+        }
+
+        int _pop(std::vector<int>& worklist, Set set)
+        {
+            while (!worklist.empty())
+            {
+                int node = worklist.back();
+                worklist.pop_back();
+
+                if (_set[node] == set)
+                    return node;
+            }
+
+            return -1;
+        }
+
+        void _move_to(int node, Set set)
+        {
+            _set[node] = set;
+
+            if (set == simplify)
+                _simplify_worklist.push_back(node);
+            else if (set == freeze)
+                _freeze_worklist.push_back(node);
+            else if (set == spill)
+                _spill_worklist.push_back(node);
+        }
+
+        void _add_edge(int u, int v)
+        {
+            if (u == v || _adj_set.contains(u, v))
+                return;
+
+            _adj_set.add(u, v);
+
+            if (_set[u] != precolored)
+            {
+                _adj_list[u].push_back(v);
+                _degree[u]++;
+            }
+
+            if (_set[v] != precolored)
+            {
+                _adj_list[v].push_back(u);
+                _degree[v]++;
+            }
+        }
+
+        void _add_move(int dst, int src)
+        {
+            if (dst < 0 || src < 0 || dst == src)
+                return;
+
+            _move_list[dst].push_back(_moves.size());
+            _move_list[src].push_back(_moves.size());
+            _move_worklist.push_back(_moves.size());
+            _moves.push_back({ dst, src, worklist_move });
+        }
+
+        void _build()
+        {
+            // live set as a sparse set, so it can be walked cheaply
+            std::vector<int> live;
+            std::vector<int> position(_nodes, -1);
+            std::vector<bool> used(_nodes, false);
+
+            auto insert = [&](int node)
+            {
+                if (position[node] < 0)
+                {
+                    position[node] = live.size();
+                    live.push_back(node);
+                }
+            };
+
+            auto erase = [&](int node)
+            {
+                if (position[node] < 0)
+                    return;
+
+                int last = live.back();
+                live[position[node]] = last;
+                position[last] = position[node];
+                live.pop_back();
+                position[node] = -1;
+            };
+
+            for (size_t b = 0; b < _function.blocks.size(); b++)
+            {
+                auto& block = _function.blocks[b];
+                double weight = std::pow(10.0, std::min(block.loop_depth, 8));
+
+                for (int node: live)
+                    position[node] = -1;
+
+                live.clear();
+
+                _function.blocks[b].live_out.for_each([&](int v) { insert(K + v); });
+
+                for (auto it = block.insts.rbegin(); it != block.insts.rend(); it++)
+                {
+                    auto& inst = *it;
+                    bool is_copy = inst.op == MInst::PMOVE || inst.op == MInst::MOV;
+
+                    for (size_t i = 0; i < inst.defs.size(); i++)
+                    {
+                        int def = _node(inst.defs[i]);
+
+                        if (def < K)
+                            continue;
+
+                        used[def] = true;
+                        _cost[def] += weight;
+
+                        // a copy does not make its ends interfere
+                        int source = is_copy ? _node(inst.uses[i]) : -1;
+
+                        for (int other: live)
+                        {
+                            if (other != source)
+                                _add_edge(def, other);
+                        }
+
+                        // destinations of a parallel copy are written together
+                        for (auto& other_def: inst.defs)
+                        {
+                            int other = _node(other_def);
+
+                            if (other >= K)
+                                _add_edge(def, other);
+                        }
+
+                        if (is_copy)
+                            _add_move(def, source);
+                    }
+
+                    if (inst.op == MInst::CALL)
+                    {
+                        // whatever survives the call stays clear of the caller saved registers
+                        for (int node: live)
+                        {
+                            if (inst.defs.empty() || node != _node(inst.defs[0]))
+                            {
+                                for (int r = 0; r < K; r++)
+                                {
+                                    if (!is_callee_saved(allocatable_regs[r]))
+                                        _add_edge(node, r);
+                                }
+                            }
+                        }
+
+                        // arguments would rather already be where the call wants them
+                        for (size_t i = 0; i < inst.uses.size() && i < std::size(arg_regs); i++)
+                            _add_move(_node(Operand::make_reg(arg_regs[i])), _node(inst.uses[i]));
+                    }
+
+                    for (auto& def: inst.defs)
+                    {
+                        int node = _node(def);
+
+                        if (node >= K)
+                            erase(node);
+                    }
+
+                    for (auto& use: inst.uses)
+                    {
+                        int node = _node(use);
+
+                        if (node < K)
+                            continue;
+
+                        used[node] = true;
+                        _cost[node] += weight;
+                        insert(node);
+                    }
+                }
+            }
+
+            for (int n = K; n < _nodes; n++)
+            {
+                if (!used[n])
+                    _set[n] = unused;
+            }
+        }
+
+        bool _is_move_related(int node)
+        {
+            for (int m: _move_list[node])
+            {
+                if (_moves[m].state == worklist_move || _moves[m].state == active_move)
+                    return true;
+            }
+
+            return false;
+        }
+
+        void _make_worklist()
+        {
+            for (int n = K; n < _nodes; n++)
+            {
+                if (_set[n] != initial)
+                    continue;
+
+                if (_degree[n] >= K)
+                    _move_to(n, spill);
+                else if (_is_move_related(n))
+                    _move_to(n, freeze);
+                else
+                    _move_to(n, simplify);
+            }
+        }
+
+        template <typename F>
+        void _for_adjacent(int node, F f)
+        {
+            for (int other: _adj_list[node])
+            {
+                if (_set[other] != on_stack && _set[other] != coalesced)
+                    f(other);
+            }
+        }
+
+        void _enable_moves(int node)
+        {
+            for (int m: _move_list[node])
+            {
+                if (_moves[m].state == active_move)
+                {
+                    _moves[m].state = worklist_move;
+                    _move_worklist.push_back(m);
+                }
+            }
+        }
+
+        void _decrement_degree(int node)
+        {
+            if (_set[node] == precolored)
+                return;
+
+            int degree = _degree[node]--;
+
+            if (degree != K)
+                return;
+
+            _enable_moves(node);
+            _for_adjacent(node, [&](int other) { _enable_moves(other); });
+
+            if (_is_move_related(node))
+                _move_to(node, freeze);
+            else
+                _move_to(node, simplify);
+        }
+
+        void _simplify(int node)
+        {
+            _set[node] = on_stack;
+            _select_stack.push_back(node);
+            _for_adjacent(node, [&](int other) { _decrement_degree(other); });
+        }
+
+        int _get_alias(int node)
+        {
+            while (_set[node] == coalesced)
+                node = _alias[node];
+
+            return node;
+        }
+
+        void _add_worklist(int node)
+        {
+            if (_set[node] != precolored && !_is_move_related(node) && _degree[node] < K)
+                _move_to(node, simplify);
+        }
+
+        // George: every neighbor of v is harmless to precolored u
+        bool _george(int u, int v)
+        {
+            bool ok = true;
+
+            _for_adjacent(v, [&](int t)
+            {
+                ok = ok && (_degree[t] < K || _set[t] == precolored || _adj_set.contains(t, u));
+            });
+
+            return ok;
+        }
+
+        // Briggs: the merged node has fewer than K neighbors of significant degree
+        bool _briggs(int u, int v)
+        {
+            _generation++;
+            int significant = 0;
+
+            auto count = [&](int t)
+            {
+                if (_mark[t] == _generation)
+                    return;
+
+                _mark[t] = _generation;
+
+                if (_degree[t] >= K)
+                    significant++;
+            };
+
+            _for_adjacent(u, count);
+            _for_adjacent(v, count);
+
+            return significant < K;
+        }
+
+        void _combine(int u, int v)
+        {
+            _set[v] = coalesced;
+            _alias[v] = u;
+            _cost[u] += _cost[v];
+
+            for (int m: _move_list[v])
+                _move_list[u].push_back(m);
+
+            _enable_moves(v);
+
+            _for_adjacent(v, [&](int t)
+            {
+                _add_edge(t, u);
+                _decrement_degree(t);
+            });
+
+            if (_degree[u] >= K && _set[u] == freeze)
+                _move_to(u, spill);
+        }
+
+        bool _coalesce()
+        {
+            int m = -1;
+
+            while (!_move_worklist.empty() && m < 0)
+            {
+                int candidate = _move_worklist.back();
+                _move_worklist.pop_back();
+
+                if (_moves[candidate].state == worklist_move)
+                    m = candidate;
+            }
+
+            if (m < 0)
+                return false;
+
+            int x = _get_alias(_moves[m].dst);
+            int y = _get_alias(_moves[m].src);
+            int u = x;
+            int v = y;
+
+            if (_set[y] == precolored)
+                std::swap(u, v);
+
+            if (u == v)
+            {
+                _moves[m].state = coalesced_move;
+                _add_worklist(u);
+            }
+            else if (_set[v] == precolored || _adj_set.contains(u, v))
+            {
+                _moves[m].state = constrained_move;
+                _add_worklist(u);
+                _add_worklist(v);
+            }
+            else if (_set[u] == precolored ? _george(u, v) : _briggs(u, v))
+            {
+                _moves[m].state = coalesced_move;
+                _combine(u, v);
+                _add_worklist(u);
+            }
+            else
+            {
+                _moves[m].state = active_move;
+            }
+
+            return true;
+        }
+
+        void _freeze_moves(int node)
+        {
+            for (int m: _move_list[node])
+            {
+                auto& move = _moves[m];
+
+                if (move.state != worklist_move && move.state != active_move)
+                    continue;
+
+                int x = _get_alias(move.dst);
+                int y = _get_alias(move.src);
+                int other = y == _get_alias(node) ? x : y;
+
+                move.state = frozen_move;
+
+                if (_set[other] == freeze && !_is_move_related(other) && _degree[other] < K)
+                    _move_to(other, simplify);
+            }
+        }
+
+        void _freeze(int node)
+        {
+            _move_to(node, simplify);
+            _freeze_moves(node);
+        }
+
+        bool _select_spill()
+        {
+            int best = -1;
+
+            for (int node: _spill_worklist)
+            {
+                if (_set[node] != spill)
+                    continue;
+
+                if (best < 0 || _cost[node] * _degree[best] < _cost[best] * _degree[node])
+                    best = node;
+            }
+
+            if (best < 0)
+                return false;
+
+            // optimistic: it may still find a color once its neighbors are placed
+            _move_to(best, simplify);
+            _freeze_moves(best);
+            return true;
+        }
+
+        Allocation _assign_colors()
+        {
+            Allocation allocation;
+            allocation.locations.resize(_function.vregs);
+
+            bool used[16] = {};
+
+            while (!_select_stack.empty())
+            {
+                int node = _select_stack.back();
+                _select_stack.pop_back();
+
+                bool ok[K];
+                std::fill(std::begin(ok), std::end(ok), true);
+
+                for (int other: _adj_list[node])
+                {
+                    int alias = _get_alias(other);
+
+                    if (_set[alias] == colored || _set[alias] == precolored)
+                        ok[_color[alias]] = false;
+                }
+
+                // caller saved registers first, they cost no save in the prologue
+                int color = -1;
+
+                for (int c = 0; c < K && color < 0; c++)
+                {
+                    if (ok[c])
+                        color = c;
+                }
+
+                if (color < 0)
+                {
+                    _set[node] = spilled;
+                    continue;
+                }
+
+                _set[node] = colored;
+                _color[node] = color;
+            }
+
+            std::vector<int> slot_of(_nodes, -1);
+
+            for (int v = 0; v < _function.vregs; v++)
+            {
+                int node = _get_alias(K + v);
+
+                if (_set[node] == unused)
+                    continue;
+
+                if (_set[node] == spilled)
+                {
+                    // registers coalesced together share their slot too
+                    if (slot_of[node] < 0)
+                        slot_of[node] = _function.slots + allocation.spill_slots++;
+
+                    allocation.locations[v] = { no_reg, slot_of[node] };
+                    continue;
+                }
+
+                Reg reg = allocatable_regs[_color[node]];
+                allocation.locations[v] = { reg, -1 };
+                used[reg] = true;
+            }
+
+            for (Reg reg: allocatable_regs)
+            {
+                if (used[reg] && is_callee_saved(reg))
+                    allocation.callee_saved.push_back(reg);
+            }
+
+            return allocation;
+        }
+    };
+}
+
+Allocation x86::allocate_graph_coloring(const MachineFunction& function)
+{
+    return Coloring(function).run();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <pseudoc/x86/machine.hpp>
+
+namespace x86
+{
+    // iterated register coalescing (George and Appel) over the interference
+    // graph of the virtual registers. phi copies, parameters and call
+    // arguments are coalesced when the Briggs or George tests allow it,
+    // calls clobber the caller saved registers and the uncolorable nodes
+    // with the lowest cost per degree, uses weighted by 10 to the loop
+    // depth, are spilled. spilled registers become frame slots the
+    // expansion reaches through its scratch registers, so no code is
+    // rewritten and one round of coloring is enough
+    Allocation allocate_graph_coloring(const MachineFunction& function);
+}
@@ -0,0 +1,490 @@
+#include <pseudoc/x86/isel.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <pseudoc/irl/analyses.hpp>
+#include <pseudoc/irl/renumber.hpp>
+
+using namespace x86;
+
+namespace
+{
+    Cond condition_of(irl::ICmp::CondT cond)
+    {
+        switch (cond)
+        {
+        case irl::ICmp::eq:
+            return e;
+
+        case irl::ICmp::ne:
+            return ne;
+
+        case irl::ICmp::ugt:
+            return a;
+
+        case irl::ICmp::uge:
+            return ae;
+
+        case irl::ICmp::ult:
+            return b;
+
+        case irl::ICmp::ule:
+            return be;
+
+        case irl::ICmp::sgt:
+            return g;
+
+        case irl::ICmp::sge:
+            return ge;
+
+        case irl::ICmp::slt:
+            return l;
+
+        default:
+            return le;
+        }
+    }
+
+    // every member spelled out, targets and symbol unset
+    MInst make_inst(MInst::Op op, bool wide = false, Cond cc = e)
+    {
+        return { op, wide, cc, { -1, -1 }, -1, {}, {} };
+    }
+
+    class Selector
+    {
+    public:
+        Selector(irl::IrlSegment& function):
+            _function(function),
+            _analyses(function),
+            _cfg(_analyses.get_cfg())
+        {
+            int bound = irl::id_bound(function);
+
+            _slot_of.assign(bound, -1);
+            _uses.assign(bound, 0);
+
+            _mf.vregs = bound;
+            _mf.blocks.resize(_cfg.size());
+
+            auto& loops = _analyses.get_loops();
+
+            for (int b = 0; b < _cfg.size(); b++)
+                _mf.blocks[b].loop_depth = loops.get_depth(b);
+
+            for (auto& instruction: function.instructions)
+            {
+                if (instruction->get_opcode() == irl::Instruction::ALLOCA)
+                    _slot_of[instruction->get_out()->id] = _mf.slots++;
+
+                for (auto operand: instruction->get_operands())
+                {
+                    if (auto var = dynamic_cast<irl::Variable*>(operand->get()))
+                        _uses[var->id]++;
+                }
+            }
+        }
+
+        MachineFunction run()
+        {
+            auto def = static_cast<irl::Def*>(_function.instructions.front().get());
+            _mf.name = def->get_id();
+
+            _select_params(def->get_params());
+
+            for (int b = 0; b < _cfg.size(); b++)
+                _select_block(b);
+
+            _map_liveness(def->get_params());
+
+            return std::move(_mf);
+        }
+
+    private:
+        irl::IrlSegment& _function;
+        irl::Analyses _analyses;
+        irl::Cfg& _cfg;
+        MachineFunction _mf;
+
+        // frame slot of each alloca, by temporary
+        std::vector<int> _slot_of;
+
+        // number of reads of each temporary
+        std::vector<int> _uses;
+
+        Operand _operand(irl::Value* value)
+        {
+            if (auto var = dynamic_cast<irl::Variable*>(value))
+            {
+                if (_slot_of[var->id] >= 0)
+                    return Operand::make_slot(_slot_of[var->id]);
+
+                return Operand::make_vreg(var->id);
+            }
+
+            if (auto literal = dynamic_cast<irl::IntLiteral*>(value))
+                return Operand::make_imm(literal->value);
+
+            throw std::logic_error("x86 backend: floating point values are not supported");
+        }
+
+        Operand _slot(irl::Value* value)
+        {
+            auto var = dynamic_cast<irl::Variable*>(value);
+
+            if (!var || _slot_of[var->id] < 0)
+                throw std::logic_error("x86 backend: memory access through something that is not an alloca");
+
+            return Operand::make_slot(_slot_of[var->id]);
+        }
+
+        static bool _is_wide(irl::Value* value)
+        {
+            return value->tp == irl::LlvmAtomic::i64;
+        }
+
+        void _select_params(const std::vector<std::shared_ptr<irl::Variable>>& params)
+        {
+            if (params.empty())
+                return;
+
+            // the first six arrive in registers, the rest above the return
+            // address and the saved rbp
+            MInst entry = make_inst(MInst::PMOVE);
+
+            for (size_t i = 0; i < params.size(); i++)
+            {
+                entry.defs.push_back(Operand::make_vreg(params[i]->id));
+
+                if (i < std::size(arg_regs))
+                    entry.uses.push_back(Operand::make_reg(arg_regs[i]));
+                else
+                    entry.uses.push_back(Operand::make_mem(rbp, 16 + 8 * (i - std::size(arg_regs))));
+            }
+
+            _mf.blocks[0].insts.push_back(std::move(entry));
+        }
+
+        // copies feeding the phis of to along the edge from -> to
+        MInst _phi_moves(int from, int to)
+        {
+            MInst moves = make_inst(MInst::PMOVE);
+            auto& label = *_cfg.get_block(from).label;
+            auto& block = _cfg.get_block(to);
+
+            for (size_t i = block.begin + 1; i < block.end; i++)
+            {
+                auto& instruction = _function.instructions[i];
+
+                if (instruction->get_opcode() != irl::Instruction::PHI)
+                    break;
+
+                auto phi = static_cast<irl::Phi*>(instruction.get());
+
+                for (auto& branch: phi->get_branches())
+                {
+                    if (branch.origin->id != label.id)
+                        continue;
+
+                    moves.defs.push_back(Operand::make_vreg(phi->get_out()->id));
+                    moves.uses.push_back(_operand(branch.val.get()));
+                    break;
+                }
+            }
+
+            return moves;
+        }
+
+        // target of the edge from -> to, split when to needs phi copies
+        int _edge_target(int from, int to)
+        {
+            auto moves = _phi_moves(from, to);
+
+            if (moves.defs.empty())
+                return to;
+
+            // inside a loop when both ends are
+            MBlock split;
+            split.loop_depth = std::min(_mf.blocks[from].loop_depth, _mf.blocks[to].loop_depth);
+            split.insts.push_back(std::move(moves));
+
+            MInst jump = make_inst(MInst::JMP);
+            jump.targets[0] = to;
+            split.insts.push_back(std::move(jump));
+
+            _mf.blocks.push_back(std::move(split));
+            return _mf.blocks.size() - 1;
+        }
+
+        void _select_block(int b)
+        {
+            auto& block = _cfg.get_block(b);
+            auto& out = _mf.blocks[b].insts;
+
+            for (size_t i = block.begin + 1; i < block.end; i++)
+            {
+                auto instruction = _function.instructions[i].get();
+                auto operands = instruction->get_operands();
+
+                switch (instruction->get_opcode())
+                {
+                case irl::Instruction::LOAD:
+                {
+                    auto res = instruction->get_out();
+                    MInst load = make_inst(MInst::MOV, _is_wide(res.get()));
+                    load.defs.push_back(Operand::make_vreg(res->id));
+                    load.uses.push_back(_slot(operands[0]->get()));
+                    out.push_back(std::move(load));
+                    break;
+                }
+
+                case irl::Instruction::STORE:
+                {
+                    auto from = operands[0]->get();
+                    MInst store = make_inst(MInst::MOV, _is_wide(from));
+                    store.defs.push_back(_slot(operands[1]->get()));
+                    store.uses.push_back(_operand(from));
+                    out.push_back(std::move(store));
+                    break;
+                }
+
+                case irl::Instruction::ADD:
+                case irl::Instruction::SUB:
+                case irl::Instruction::MUL:
+                case irl::Instruction::SDIV:
+                {
+                    static constexpr MInst::Op ops[] = { MInst::ADD, MInst::SUB, MInst::IMUL, MInst::SDIV };
+
+                    auto res = instruction->get_out();
+                    MInst binary = make_inst(ops[instruction->get_opcode() - irl::Instruction::ADD], _is_wide(res.get()));
+                    binary.defs.push_back(Operand::make_vreg(res->id));
+                    binary.uses.push_back(_operand(operands[0]->get()));
+                    binary.uses.push_back(_operand(operands[1]->get()));
+                    out.push_back(std::move(binary));
+                    break;
+                }
+
+                case irl::Instruction::ICMP:
+                {
+                    auto cmp = static_cast<irl::ICmp*>(instruction);
+                    auto res = cmp->get_out();
+
+                    // a compare only feeding the branch right after it becomes part of the branch
+                    auto next = _function.instructions[i + 1].get();
+
+                    if (next->get_opcode() == irl::Instruction::JUMPC && _uses[res->id] == 1
+                        && static_cast<irl::JumpC*>(next)->get_condition() == res)
+                    {
+                        _select_branch(b, static_cast<irl::JumpC*>(next), cmp);
+                        return;
+                    }
+
+                    MInst setcc = make_inst(MInst::SETCC, _is_wide(operands[0]->get()), condition_of(cmp->get_cond()));
+                    setcc.defs.push_back(Operand::make_vreg(res->id));
+                    setcc.uses.push_back(_operand(operands[0]->get()));
+                    setcc.uses.push_back(_operand(operands[1]->get()));
+                    out.push_back(std::move(setcc));
+                    break;
+                }
+
+                case irl::Instruction::ZEXT:
+                {
+                    auto res = instruction->get_out();
+                    MInst zext = make_inst(MInst::ZEXT, _is_wide(res.get()));
+                    zext.defs.push_back(Operand::make_vreg(res->id));
+                    zext.uses.push_back(_operand(operands[0]->get()));
+                    out.push_back(std::move(zext));
+                    break;
+                }
+
+                case irl::Instruction::CALL:
+                {
+                    auto call = static_cast<irl::Call*>(instruction);
+                    auto res = call->get_out();
+
+                    MInst machine_call = make_inst(MInst::CALL, res && _is_wide(res.get()));
+                    machine_call.symbol = _mf.add_symbol(call->get_id());
+
+                    if (res)
+                        machine_call.defs.push_back(Operand::make_vreg(res->id));
+
+                    for (auto operand: operands)
+                        machine_call.uses.push_back(_operand(operand->get()));
+
+                    out.push_back(std::move(machine_call));
+                    break;
+                }
+
+                case irl::Instruction::RET:
+                {
+                    MInst ret = make_inst(MInst::RET);
+
+                    if (!operands.empty())
+                    {
+                        ret.wide = _is_wide(operands[0]->get());
+                        ret.uses.push_back(_operand(operands[0]->get()));
+                    }
+
+                    out.push_back(std::move(ret));
+                    break;
+                }
+
+                case irl::Instruction::JUMP:
+                {
+                    int to = _cfg.get_block_of(*static_cast<irl::Jump*>(instruction)->get_target());
+                    auto moves = _phi_moves(b, to);
+
+                    if (!moves.defs.empty())
+                        out.push_back(std::move(moves));
+
+                    MInst jump = make_inst(MInst::JMP);
+                    jump.targets[0] = to;
+                    out.push_back(std::move(jump));
+                    break;
+                }
+
+                case irl::Instruction::JUMPC:
+                    _select_branch(b, static_cast<irl::JumpC*>(instruction), nullptr);
+                    break;
+
+                default:
+                    // allocas are frame slots, phis are copies on the incoming edges
+                    // and labels are block boundaries
+                    break;
+                }
+            }
+        }
+
+        // live sets of the machine blocks from the irl ones, without solving
+        // again. a phi result is written by the copies at the end of the
+        // incoming edges, so it is live into its block when read there or
+        // passed on. allocas are frame slots, not registers, and the
+        // parameters are written by the copy at the top of the entry block
+        void _map_liveness(const std::vector<std::shared_ptr<irl::Variable>>& params)
+        {
+            auto& liveness = _analyses.get_liveness();
+            irl::BitSet slots(_mf.vregs);
+            irl::BitSet read(_mf.vregs);
+
+            for (int id = 0; id < _mf.vregs; id++)
+            {
+                if (_slot_of[id] >= 0)
+                    slots.set(id);
+            }
+
+            for (int b = 0; b < _cfg.size(); b++)
+            {
+                auto& block = _cfg.get_block(b);
+                auto& live_in = _mf.blocks[b].live_in;
+
+                live_in = liveness.get_live_in(b);
+                read.clear();
+
+                for (auto& inst: _mf.blocks[b].insts)
+                {
+                    for (auto& use: inst.uses)
+                    {
+                        if (use.kind == Operand::vreg)
+                            read.set(use.value);
+                    }
+                }
+
+                for (size_t i = block.begin + 1; i < block.end; i++)
+                {
+                    auto& instruction = _function.instructions[i];
+
+                    if (instruction->get_opcode() != irl::Instruction::PHI)
+                        break;
+
+                    int id = instruction->get_out()->id;
+
+                    if (read.test(id) || liveness.get_live_out(b).test(id))
+                        live_in.set(id);
+                }
+
+                live_in.subtract(slots);
+            }
+
+            for (auto& param: params)
+                _mf.blocks[0].live_in.reset(param->id);
+
+            // a split block reads the phi operands and passes the rest on
+            for (size_t s = _cfg.size(); s < _mf.blocks.size(); s++)
+            {
+                auto& split = _mf.blocks[s];
+                auto& moves = split.insts.front();
+
+                split.live_in = _mf.blocks[split.insts.back().targets[0]].live_in;
+
+                for (auto& def: moves.defs)
+                    split.live_in.reset(def.value);
+
+                for (auto& use: moves.uses)
+                {
+                    if (use.kind == Operand::vreg)
+                        split.live_in.set(use.value);
+                }
+            }
+
+            for (auto& block: _mf.blocks)
+            {
+                block.live_out = irl::BitSet(_mf.vregs);
+
+                for (int succ: block.successors())
+                    block.live_out.unite(_mf.blocks[succ].live_in);
+            }
+        }
+
+        void _select_branch(int b, irl::JumpC* jump, irl::ICmp* cmp)
+        {
+            int on_true = _cfg.get_block_of(*jump->get_on_true());
+            int on_false = _cfg.get_block_of(*jump->get_on_false());
+            auto condition = jump->get_condition();
+
+            // nothing to decide, the edge is taken whatever the condition
+            if (on_true == on_false || dynamic_cast<irl::IntLiteral*>(condition.get()))
+            {
+                int to = on_true;
+
+                if (on_true != on_false && static_cast<irl::IntLiteral*>(condition.get())->value == 0)
+                    to = on_false;
+
+                auto moves = _phi_moves(b, to);
+
+                if (!moves.defs.empty())
+                    _mf.blocks[b].insts.push_back(std::move(moves));
+
+                MInst uncond = make_inst(MInst::JMP);
+                uncond.targets[0] = to;
+                _mf.blocks[b].insts.push_back(std::move(uncond));
+                return;
+            }
+
+            MInst branch = make_inst(cmp ? MInst::CMP_JUMP : MInst::TEST_JUMP);
+
+            if (cmp)
+            {
+                auto operands = cmp->get_operands();
+
+                branch.wide = _is_wide(operands[0]->get());
+                branch.cc = condition_of(cmp->get_cond());
+                branch.uses.push_back(_operand(operands[0]->get()));
+                branch.uses.push_back(_operand(operands[1]->get()));
+            }
+            else
+            {
+                branch.uses.push_back(_operand(condition.get()));
+            }
+
+            branch.targets[0] = _edge_target(b, on_true);
+            branch.targets[1] = _edge_target(b, on_false);
+            _mf.blocks[b].insts.push_back(std::move(branch));
+        }
+    };
+}
+
+MachineFunction x86::select(irl::IrlSegment& function)
+{
+    return Selector(function).run();
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <pseudoc/irl/segment.hpp>
+#include <pseudoc/x86/machine.hpp>
+
+namespace x86
+{
+    // selects machine instructions for a function segment (Def ... EndDef),
+    // which must have gone through irl::renumber. temporaries keep their
+    // numbers as virtual registers, machine block i is irl block i and the
+    // blocks split from critical edges to phis are appended after them.
+    // the live sets of the blocks come from the cached irl::Liveness
+    MachineFunction select(irl::IrlSegment& function);
+}
@@ -0,0 +1,135 @@
+#include <pseudoc/x86/jit.hpp>
+
+#include <cstring>
+#include <dlfcn.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#include <pseudoc/x86/backend.hpp>
+#include <pseudoc/x86/encoder.hpp>
+
+using namespace x86;
+
+namespace
+{
+    // jmp *0(%rip) followed by the absolute target
+    constexpr size_t stub_size = 16;
+
+    size_t align_up(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+Jit::Jit(std::shared_ptr<FunctionTable> ftable, int level):
+    _ftable(std::move(ftable)),
+    _level(level)
+{
+}
+
+Jit::~Jit()
+{
+    for (auto& mapping: _mappings)
+        munmap(mapping.address, mapping.size);
+}
+
+void Jit::add(std::vector<std::unique_ptr<irl::IrlSegment>>& module)
+{
+    std::vector<MachineCode> functions;
+    std::unordered_map<std::string, size_t> offset_of;
+    size_t size = 0;
+
+    for (auto& segment: module)
+    {
+        if (segment->instructions.empty() || segment->instructions.front()->get_opcode() != irl::Instruction::DEF)
+            continue;
+
+        functions.push_back(encode(compile(*segment, _level)));
+
+        size = align_up(size, 16);
+        offset_of[functions.back().name] = size;
+        size += functions.back().bytes.size();
+    }
+
+    if (functions.empty())
+        return;
+
+    // one stub per callee outside the batch, after the code
+    std::unordered_map<std::string, size_t> stub_of;
+    std::vector<std::pair<size_t, void*>> stubs;
+    size = align_up(size, 16);
+
+    for (auto& function: functions)
+    {
+        for (auto& call: function.calls)
+        {
+            auto& callee = function.symbols[call.symbol];
+
+            if (offset_of.count(callee) || stub_of.count(callee))
+                continue;
+
+            void* target = _ftable->get_address(callee);
+
+            if (!target)
+                target = dlsym(RTLD_DEFAULT, callee.c_str());
+
+            if (!target)
+                throw std::logic_error("jit: unresolved function " + callee);
+
+            stub_of[callee] = size;
+            stubs.emplace_back(size, target);
+            size += stub_size;
+        }
+    }
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size = align_up(size, page);
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED)
+        throw std::runtime_error("jit: could not map memory for the code");
+
+    _mappings.push_back({ memory, size });
+    auto base = static_cast<uint8_t*>(memory);
+
+    // int3 on the padding, so stray jumps trap
+    std::memset(base, 0xcc, size);
+
+    for (auto& function: functions)
+    {
+        size_t start = offset_of[function.name];
+        std::memcpy(base + start, function.bytes.data(), function.bytes.size());
+
+        for (auto& call: function.calls)
+        {
+            auto& callee = function.symbols[call.symbol];
+            auto it = offset_of.find(callee);
+            size_t target = it != offset_of.end() ? it->second : stub_of[callee];
+
+            // relative to the end of the rel32 field
+            int32_t disp = static_cast<int64_t>(target) - static_cast<int64_t>(start + call.offset + 4);
+            std::memcpy(base + start + call.offset, &disp, sizeof(disp));
+        }
+    }
+
+    for (auto& [offset, target]: stubs)
+    {
+        static constexpr uint8_t jump[] = { 0xff, 0x25, 0, 0, 0, 0 };
+        std::memcpy(base + offset, jump, sizeof(jump));
+        std::memcpy(base + offset + sizeof(jump), &target, sizeof(target));
+    }
+
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+        throw std::runtime_error("jit: could not make the code executable");
+
+    for (auto& function: functions)
+        _ftable->set_address(function.name, base + offset_of[function.name]);
+}
+
+void* Jit::get_address(const std::string& id) const
+{
+    return _ftable->get_address(id);
+}
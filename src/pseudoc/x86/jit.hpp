@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pseudoc/irl/segment.hpp>
+#include <pseudoc/variable-map.hpp>
+
+namespace x86
+{
+    // compiles function segments into executable memory of this process.
+    // every batch gets its own pages, written while they are only
+    // writable and then flipped to read and execute (never both). calls
+    // inside a batch are direct, the others go through an absolute jump
+    // stub: to functions of earlier batches, found on the FunctionTable,
+    // or to functions of the process (libc and the like) by name
+    class Jit
+    {
+    public:
+        // level picks the register allocator, as in compile
+        Jit(std::shared_ptr<FunctionTable> ftable, int level = 0);
+        ~Jit();
+
+        Jit(Jit& other) = delete;
+        Jit& operator = (Jit& other) = delete;
+
+        // compiles the definitions of the module (renumbered) and records
+        // their entry points on the FunctionTable
+        void add(std::vector<std::unique_ptr<irl::IrlSegment>>& module);
+
+        // entry point of a compiled function, null when there is none
+        void* get_address(const std::string& id) const;
+
+        template <typename F>
+        F* get_function(const std::string& id) const
+        {
+            return reinterpret_cast<F*>(get_address(id));
+        }
+
+    private:
+        struct Mapping
+        {
+            void* address;
+            size_t size;
+        };
+
+        std::shared_ptr<FunctionTable> _ftable;
+        int _level;
+        std::vector<Mapping> _mappings;
+    };
+}
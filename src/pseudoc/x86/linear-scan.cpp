@@ -0,0 +1,223 @@
+#include <pseudoc/x86/linear-scan.hpp>
+
+#include <algorithm>
+#include <climits>
+
+using namespace x86;
+
+namespace
+{
+    struct Interval
+    {
+        int start = INT_MAX;
+        int end = -1;
+        bool crosses_call = false;
+
+        // register or virtual register it is copied from, tried first
+        Reg hint_reg = no_reg;
+        int hint_vreg = -1;
+    };
+
+    constexpr Reg callee_saved_regs[] = { rbx, r12, r13, r14, r15 };
+
+    // instruction k reads at 2k and writes at 2k + 1, so an interval
+    // ending at a read can share its register with one starting there
+    std::vector<Interval> build_intervals(const MachineFunction& function)
+    {
+        std::vector<Interval> intervals(function.vregs);
+        std::vector<int> calls;
+
+        auto extend = [&](int vreg, int pos)
+        {
+            auto& interval = intervals[vreg];
+            interval.start = std::min(interval.start, pos);
+            interval.end = std::max(interval.end, pos);
+        };
+
+        int pos = 0;
+
+        for (size_t b = 0; b < function.blocks.size(); b++)
+        {
+            int first = pos;
+
+            for (auto& inst: function.blocks[b].insts)
+            {
+                for (auto& use: inst.uses)
+                {
+                    if (use.kind == Operand::vreg)
+                        extend(use.value, pos);
+                }
+
+                for (size_t i = 0; i < inst.defs.size(); i++)
+                {
+                    auto& def = inst.defs[i];
+
+                    if (def.kind != Operand::vreg)
+                        continue;
+
+                    extend(def.value, pos + 1);
+
+                    if (inst.op != MInst::MOV && inst.op != MInst::PMOVE)
+                        continue;
+
+                    auto& use = inst.uses[i];
+
+                    if (use.kind == Operand::vreg)
+                        intervals[def.value].hint_vreg = use.value;
+                    else if (use.kind == Operand::reg)
+                        intervals[def.value].hint_reg = use.base;
+                }
+
+                if (inst.op == MInst::CALL)
+                {
+                    calls.push_back(pos);
+
+                    for (size_t i = 0; i < inst.uses.size() && i < std::size(arg_regs); i++)
+                    {
+                        if (inst.uses[i].kind == Operand::vreg)
+                            intervals[inst.uses[i].value].hint_reg = arg_regs[i];
+                    }
+                }
+
+                pos += 2;
+            }
+
+            int last = pos - 1;
+
+            function.blocks[b].live_in.for_each([&](int v) { extend(v, first); });
+            function.blocks[b].live_out.for_each([&](int v) { extend(v, last); });
+        }
+
+        // live before the call and read after it, the arguments and the
+        // result themselves do not count
+        for (auto& interval: intervals)
+        {
+            auto call = std::upper_bound(calls.begin(), calls.end(), interval.start);
+            interval.crosses_call = call != calls.end() && *call + 1 < interval.end;
+        }
+
+        return intervals;
+    }
+}
+
+Allocation x86::allocate_linear_scan(const MachineFunction& function)
+{
+    auto intervals = build_intervals(function);
+
+    Allocation allocation;
+    allocation.locations.resize(function.vregs);
+
+    std::vector<int> order;
+
+    for (int v = 0; v < function.vregs; v++)
+    {
+        if (intervals[v].end >= 0)
+            order.push_back(v);
+    }
+
+    std::sort(order.begin(), order.end(), [&](int lhs, int rhs)
+    {
+        return intervals[lhs].start < intervals[rhs].start;
+    });
+
+    std::vector<int> active;
+    bool used[16] = {};
+    bool taken[16] = {};
+
+    auto spill = [&](int vreg)
+    {
+        allocation.locations[vreg] = { no_reg, function.slots + allocation.spill_slots++ };
+    };
+
+    for (int v: order)
+    {
+        auto& current = intervals[v];
+
+        // expire the intervals over before this one starts
+        active.erase(std::remove_if(active.begin(), active.end(), [&](int other)
+        {
+            if (intervals[other].end >= current.start)
+                return false;
+
+            taken[allocation.locations[other].reg] = false;
+            return true;
+        }), active.end());
+
+        auto allowed = [&](Reg reg)
+        {
+            return reg != no_reg && !taken[reg] && (!current.crosses_call || is_callee_saved(reg))
+                && std::find(std::begin(allocatable_regs), std::end(allocatable_regs), reg) != std::end(allocatable_regs);
+        };
+
+        Reg reg = no_reg;
+
+        if (allowed(current.hint_reg))
+            reg = current.hint_reg;
+        else if (current.hint_vreg >= 0 && allowed(allocation.locations[current.hint_vreg].reg))
+            reg = allocation.locations[current.hint_vreg].reg;
+        else if (current.crosses_call)
+        {
+            for (Reg candidate: callee_saved_regs)
+            {
+                if (allowed(candidate))
+                {
+                    reg = candidate;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for (Reg candidate: allocatable_regs)
+            {
+                if (allowed(candidate))
+                {
+                    reg = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (reg == no_reg)
+        {
+            // take the register of the active interval ending last, when it
+            // ends after this one and its register would do
+            int victim = -1;
+
+            for (int other: active)
+            {
+                Reg other_reg = allocation.locations[other].reg;
+
+                if (current.crosses_call && !is_callee_saved(other_reg))
+                    continue;
+
+                if (victim < 0 || intervals[other].end > intervals[victim].end)
+                    victim = other;
+            }
+
+            if (victim < 0 || intervals[victim].end <= current.end)
+            {
+                spill(v);
+                continue;
+            }
+
+            reg = allocation.locations[victim].reg;
+            spill(victim);
+            active.erase(std::find(active.begin(), active.end(), victim));
+            taken[reg] = false;
+        }
+
+        allocation.locations[v] = { reg, -1 };
+        taken[reg] = true;
+        used[reg] = true;
+        active.push_back(v);
+    }
+
+    for (Reg reg: callee_saved_regs)
+    {
+        if (used[reg])
+            allocation.callee_saved.push_back(reg);
+    }
+
+    return allocation;
+}
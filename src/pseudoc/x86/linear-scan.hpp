@@ -0,0 +1,13 @@
+#pragma once
+
+#include <pseudoc/x86/machine.hpp>
+
+namespace x86
+{
+    // Poletto and Sarkar linear scan: every virtual register gets a single
+    // interval from its first to its last live position, holes included.
+    // intervals live across a call only take callee saved registers, and
+    // when no register is left the interval ending last is spilled to a
+    // frame slot for its whole life
+    Allocation allocate_linear_scan(const MachineFunction& function);
+}
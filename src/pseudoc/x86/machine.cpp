@@ -0,0 +1,64 @@
+#include <pseudoc/x86/machine.hpp>
+
+using namespace x86;
+
+std::string_view x86::reg_name(Reg reg, int size)
+{
+    static constexpr std::string_view names[16][3] =
+    {
+        { "al", "eax", "rax" },
+        { "cl", "ecx", "rcx" },
+        { "dl", "edx", "rdx" },
+        { "bl", "ebx", "rbx" },
+        { "spl", "esp", "rsp" },
+        { "bpl", "ebp", "rbp" },
+        { "sil", "esi", "rsi" },
+        { "dil", "edi", "rdi" },
+        { "r8b", "r8d", "r8" },
+        { "r9b", "r9d", "r9" },
+        { "r10b", "r10d", "r10" },
+        { "r11b", "r11d", "r11" },
+        { "r12b", "r12d", "r12" },
+        { "r13b", "r13d", "r13" },
+        { "r14b", "r14d", "r14" },
+        { "r15b", "r15d", "r15" }
+    };
+
+    return names[reg][size == 1 ? 0 : size == 4 ? 1 : 2];
+}
+
+std::vector<int> MBlock::successors() const
+{
+    if (insts.empty())
+        return {};
+
+    auto& last = insts.back();
+
+    switch (last.op)
+    {
+    case MInst::JMP:
+        return { last.targets[0] };
+
+    case MInst::CMP_JUMP:
+    case MInst::TEST_JUMP:
+        if (last.targets[0] == last.targets[1])
+            return { last.targets[0] };
+
+        return { last.targets[0], last.targets[1] };
+
+    default:
+        return {};
+    }
+}
+
+int MachineFunction::add_symbol(const std::string& symbol)
+{
+    for (size_t i = 0; i < symbols.size(); i++)
+    {
+        if (symbols[i] == symbol)
+            return i;
+    }
+
+    symbols.push_back(symbol);
+    return symbols.size() - 1;
+}
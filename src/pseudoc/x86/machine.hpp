@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pseudoc/irl/bitset.hpp>
+
+namespace x86
+{
+    // general purpose registers, in hardware encoding order
+    enum Reg : int8_t
+    {
+        rax,
+        rcx,
+        rdx,
+        rbx,
+        rsp,
+        rbp,
+        rsi,
+        rdi,
+        r8,
+        r9,
+        r10,
+        r11,
+        r12,
+        r13,
+        r14,
+        r15,
+        no_reg = -1
+    };
+
+    // condition codes, in hardware encoding order
+    enum Cond : int8_t
+    {
+        o,
+        no,
+        b,
+        ae,
+        e,
+        ne,
+        be,
+        a,
+        s,
+        ns,
+        p,
+        np,
+        l,
+        ge,
+        le,
+        g
+    };
+
+    constexpr Cond negate(Cond cc)
+    {
+        return static_cast<Cond>(cc ^ 1);
+    }
+
+    // name of the register at the size in bytes (1, 4 or 8), without the %
+    std::string_view reg_name(Reg reg, int size);
+
+    constexpr Reg arg_regs[] = { rdi, rsi, rdx, rcx, r8, r9 };
+
+    constexpr bool is_callee_saved(Reg reg)
+    {
+        return reg == rbx || reg == rbp || (reg >= r12 && reg <= r15);
+    }
+
+    // rax, rdx and r11 are left out of allocation: rax and rdx for
+    // division and returns, and r11 together with rax as scratch when
+    // an instruction needs an operand in a register
+    constexpr Reg allocatable_regs[] = { rcx, rsi, rdi, r8, r9, r10, rbx, r12, r13, r14, r15 };
+
+    struct Operand
+    {
+        enum Kind : char
+        {
+            none,
+            reg,
+            imm,
+
+            // base register plus displacement
+            mem,
+
+            // before allocation: virtual registers and frame slots
+            vreg,
+            slot
+        };
+
+        Kind kind = none;
+        Reg base = no_reg;
+        int64_t value = 0;
+
+        static Operand make_reg(Reg reg) { return { Kind::reg, reg }; }
+        static Operand make_imm(int64_t value) { return { Kind::imm, no_reg, value }; }
+        static Operand make_mem(Reg base, int64_t disp) { return { Kind::mem, base, disp }; }
+        static Operand make_vreg(int vreg) { return { Kind::vreg, no_reg, vreg }; }
+        static Operand make_slot(int slot) { return { Kind::slot, no_reg, slot }; }
+
+        bool operator == (const Operand& other) const
+        {
+            return kind == other.kind && base == other.base && value == other.value;
+        }
+
+        bool operator != (const Operand& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    // machine instruction over virtual registers, as selected from irl
+    struct MInst
+    {
+        enum Op : char
+        {
+            // defs[0] = uses[0], loads and stores have a frame slot on one side
+            MOV,
+
+            // defs[0] = zero extension of uses[0] to 64 bits
+            ZEXT,
+
+            // defs[0] = uses[0] op uses[1]
+            ADD,
+            SUB,
+            IMUL,
+            SDIV,
+
+            // defs[0] = uses[0] cc uses[1] ? 1 : 0
+            SETCC,
+
+            // jumps to targets[0] when uses[0] cc uses[1], else to targets[1]
+            CMP_JUMP,
+
+            // jumps to targets[0] when uses[0] is not zero, else to targets[1]
+            TEST_JUMP,
+
+            JMP,
+
+            // returns uses[0], if any
+            RET,
+
+            // calls symbol with uses as arguments, result in defs[0] if any
+            CALL,
+
+            // every defs[i] = uses[i], all at once
+            PMOVE
+        };
+
+        Op op;
+        bool wide = false;
+        Cond cc = e;
+        int targets[2] = { -1, -1 };
+        int symbol = -1;
+
+        std::vector<Operand> defs;
+        std::vector<Operand> uses;
+    };
+
+    struct MBlock
+    {
+        std::vector<MInst> insts;
+
+        // number of loops around the block, for spill costs
+        int loop_depth = 0;
+
+        // virtual registers live on entry and on exit, set by select
+        irl::BitSet live_in;
+        irl::BitSet live_out;
+
+        std::vector<int> successors() const;
+    };
+
+    struct MachineFunction
+    {
+        std::string name;
+        std::vector<MBlock> blocks;
+        std::vector<std::string> symbols;
+
+        int vregs = 0;
+        int slots = 0;
+
+        int new_vreg()
+        {
+            return vregs++;
+        }
+
+        int add_symbol(const std::string& symbol);
+    };
+
+    // where a virtual register ended up
+    struct Location
+    {
+        Reg reg = no_reg;
+
+        // frame slot of a spilled register, -1 when in a register
+        int slot = -1;
+    };
+
+    struct Allocation
+    {
+        std::vector<Location> locations;
+
+        // spill slots come after the slots of the function
+        int spill_slots = 0;
+
+        std::vector<Reg> callee_saved;
+    };
+}
@@ -0,0 +1,65 @@
+// register pressure, calls with stack arguments, division and phi cycles for the x86 backend
+int many(int a, int b, int c, int d, int e, int f, int g, int h)
+{
+    return a - b + c * d - e / f + g * 3 - h;
+}
+
+int fib(int n)
+{
+    if (n < 2)
+        return n;
+
+    return fib(n - 1) + fib(n - 2);
+}
+
+int pressure(int n)
+{
+    int a = n + 1;
+    int b = n + 2;
+    int c = n + 3;
+    int d = n + 4;
+    int e = n + 5;
+    int f = n + 6;
+    int g = n + 7;
+    int h = n + 8;
+    int i = n + 9;
+    int j = n + 10;
+    int k = n + 11;
+    int l = n + 12;
+    int m = n + 13;
+    int o = n + 14;
+    int p = fib(n);
+    return a * b - c + d * e - f + g * h - i + j * k - l + m * o - p;
+}
+
+int swap(int n)
+{
+    int x = 1;
+    int y = 2;
+    int i = 0;
+
+    while (i < n)
+    {
+        int t = x;
+        x = y;
+        y = t;
+        i = i + 1;
+    }
+
+    return x * 10 + y;
+}
+
+int divs(int a, int b)
+{
+    return a / b + (0 - a) / b + 100 / a;
+}
+
+int main()
+{
+    int r = many(1, 2, 3, 4, 5, 6, 7, 8);
+    r = r + fib(10);
+    r = r + pressure(5);
+    r = r + swap(3);
+    r = r + divs(7, 2);
+    return r;
+}
@@ -0,0 +1,23 @@
+// repeated subexpressions, for value numbering
+int square_sum(int a, int b)
+{
+    return a * b + a * b;
+}
+
+int reused(int a, int b)
+{
+    int x = (a + b) * (b + a);
+    int y = 0;
+
+    if (a > b)
+        y = (a + b) * 2;
+    else
+        y = (b + a) * 3;
+
+    return x + y + (a + b);
+}
+
+int main()
+{
+    return square_sum(3, 4) + reused(2, 1);
+}
@@ -0,0 +1,53 @@
+// constant expressions and branches on them, for the folding passes
+int arithmetic(int x)
+{
+    int a = 2 * 3 + 4;
+    int b = a * a - 100 / 5;
+
+    return b + x;
+}
+
+int branches(int x)
+{
+    int debug = 0;
+    int res = x;
+
+    if (debug)
+        res = res * 1000;
+
+    if (2 > 1 && 3 != 3 || 4 <= 5)
+        res = res + 1;
+    else
+        res = res - 1;
+
+    return res;
+}
+
+int propagated(int n)
+{
+    int step = 1;
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (step == 1)
+            total = total + step;
+        else
+            total = total * 2;
+    }
+
+    return total;
+}
+
+int selected(int x)
+{
+    int a = 3 >= 2 ? 5 : 6;
+    int b = x >= 2 ? 10 : 20;
+
+    return a + b;
+}
+
+int main()
+{
+    return arithmetic(1) + branches(5) + propagated(7) + selected(2);
+}
@@ -0,0 +1,18 @@
+int external(int a);
+
+int caller(int a)
+{
+    return callee(a, 2) + external(a);
+}
+
+int callee(int a, int b)
+{
+    return a * b;
+}
+
+int external(int a);
+
+int main()
+{
+    return caller(3);
+}
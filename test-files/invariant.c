@@ -0,0 +1,36 @@
+// loop invariant computations at several nesting levels
+int grid(int n, int m, int scale)
+{
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < m; j++)
+        {
+            int base = scale * scale + n * m;
+            int row = i * scale;
+
+            total = total + base + row + j;
+        }
+    }
+
+    return total;
+}
+
+int countdown(int n, int k)
+{
+    int total = 0;
+
+    while (n > 0)
+    {
+        total = total + k * 3 + (k + 1) * (k + 2);
+        n = n - 1;
+    }
+
+    return total;
+}
+
+int main()
+{
+    return grid(100, 100, 7) / 1000000 + countdown(5, 2);
+}
@@ -0,0 +1,58 @@
+// loop shapes for the ssa passes: counted, nested, early exits and dead code
+int sum(int n)
+{
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+        total += i;
+
+    return total;
+}
+
+int nested(int n)
+{
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < i; j++)
+            total += i * j;
+    }
+
+    return total;
+}
+
+int search(int n)
+{
+    int i = 0;
+
+    while (1)
+    {
+        if (i * i > n)
+            break;
+
+        i++;
+    }
+
+    return i;
+}
+
+int early(int n)
+{
+    while (n > 0)
+    {
+        if (n == 7)
+            return n;
+
+        n = n - 1;
+        continue;
+        n = n + 100;
+    }
+
+    return 0 - 1;
+}
+
+int main()
+{
+    return sum(10) + nested(5) + search(50) + early(20);
+}
@@ -0,0 +1,6 @@
+// a comparison used as an int operand, rejected with "Type mismatch" at
+// every level, folded or not
+int main()
+{
+    return (3 == 3) + 1;
+}
@@ -0,0 +1,9 @@
+// a comparison compared against an int, rejected with "Type mismatch" at
+// every level, folded or not
+int main()
+{
+    if ((1 < 2) == 1)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,9 @@
+// a comparison as a branch of an int conditional, rejected with "Incompatible
+// types" at every level, even when the condition folds and drops that branch
+int main()
+{
+    int x = 1;
+    int a = 1 ? 3 : (x < 2);
+
+    return a;
+}
@@ -0,0 +1,33 @@
+// products of constants and variables, in both orders and with wide factors
+int g(int a)
+{
+    return 7 * a;
+}
+
+int h(int a)
+{
+    return a * 9;
+}
+
+int wide(int a)
+{
+    return 1000 * a - a * 999;
+}
+
+int accumulate(int n)
+{
+    int x = 1;
+
+    while (n > 0)
+    {
+        x = 3 * x;
+        n = n - 1;
+    }
+
+    return x;
+}
+
+int main()
+{
+    return g(3) + h(2) + wide(5) + accumulate(4);
+}
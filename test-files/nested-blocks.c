@@ -0,0 +1,268 @@
+// deeply nested blocks, each one shadowing x and reading the outer scopes
+int nested(int x)
+{
+    int vaa = x;
+    {
+        int x = vaa + 1;
+        int vab = x + vaa;
+        {
+            int x = vab + 1;
+            int vac = x + vaa;
+            {
+                int x = vac + 1;
+                int vad = x + vaa;
+                {
+                    int x = vad + 1;
+                    int vae = x + vaa;
+                    {
+                        int x = vae + 1;
+                        int vaf = x + vaa;
+                        {
+                            int x = vaf + 1;
+                            int vag = x + vaa;
+                            {
+                                int x = vag + 1;
+                                int vah = x + vaa;
+                                {
+                                    int x = vah + 1;
+                                    int vai = x + vaa;
+                                    {
+                                        int x = vai + 1;
+                                        int vaj = x + vaa;
+                                        {
+                                            int x = vaj + 1;
+                                            int vak = x + vaa;
+                                            {
+                                                int x = vak + 1;
+                                                int val = x + vaa;
+                                                {
+                                                    int x = val + 1;
+                                                    int vam = x + vaa;
+                                                    {
+                                                        int x = vam + 1;
+                                                        int van = x + vaa;
+                                                        {
+                                                            int x = van + 1;
+                                                            int vao = x + vaa;
+                                                            {
+                                                                int x = vao + 1;
+                                                                int vap = x + vaa;
+                                                                {
+                                                                    int x = vap + 1;
+                                                                    int vaq = x + vaa;
+                                                                    {
+                                                                        int x = vaq + 1;
+                                                                        int var = x + vaa;
+                                                                        {
+                                                                            int x = var + 1;
+                                                                            int vas = x + vaa;
+                                                                            {
+                                                                                int x = vas + 1;
+                                                                                int vat = x + vaa;
+                                                                                {
+                                                                                    int x = vat + 1;
+                                                                                    int vau = x + vaa;
+                                                                                    {
+                                                                                        int x = vau + 1;
+                                                                                        int vav = x + vaa;
+                                                                                        {
+                                                                                            int x = vav + 1;
+                                                                                            int vaw = x + vaa;
+                                                                                            {
+                                                                                                int x = vaw + 1;
+                                                                                                int vax = x + vaa;
+                                                                                                {
+                                                                                                    int x = vax + 1;
+                                                                                                    int vay = x + vaa;
+                                                                                                    {
+                                                                                                        int x = vay + 1;
+                                                                                                        int vaz = x + vaa;
+                                                                                                        {
+                                                                                                            int x = vaz + 1;
+                                                                                                            int vba = x + vaa;
+                                                                                                            {
+                                                                                                                int x = vba + 1;
+                                                                                                                int vbb = x + vaa;
+                                                                                                                {
+                                                                                                                    int x = vbb + 1;
+                                                                                                                    int vbc = x + vaa;
+                                                                                                                    {
+                                                                                                                        int x = vbc + 1;
+                                                                                                                        int vbd = x + vaa;
+                                                                                                                        {
+                                                                                                                            int x = vbd + 1;
+                                                                                                                            int vbe = x + vaa;
+                                                                                                                            {
+                                                                                                                                int x = vbe + 1;
+                                                                                                                                int vbf = x + vaa;
+                                                                                                                                {
+                                                                                                                                    int x = vbf + 1;
+                                                                                                                                    int vbg = x + vaa;
+                                                                                                                                    {
+                                                                                                                                        int x = vbg + 1;
+                                                                                                                                        int vbh = x + vaa;
+                                                                                                                                        {
+                                                                                                                                            int x = vbh + 1;
+                                                                                                                                            int vbi = x + vaa;
+                                                                                                                                            {
+                                                                                                                                                int x = vbi + 1;
+                                                                                                                                                int vbj = x + vaa;
+                                                                                                                                                {
+                                                                                                                                                    int x = vbj + 1;
+                                                                                                                                                    int vbk = x + vaa;
+                                                                                                                                                    {
+                                                                                                                                                        int x = vbk + 1;
+                                                                                                                                                        int vbl = x + vaa;
+                                                                                                                                                        {
+                                                                                                                                                            int x = vbl + 1;
+                                                                                                                                                            int vbm = x + vaa;
+                                                                                                                                                            {
+                                                                                                                                                                int x = vbm + 1;
+                                                                                                                                                                int vbn = x + vaa;
+                                                                                                                                                                {
+                                                                                                                                                                    int x = vbn + 1;
+                                                                                                                                                                    int vbo = x + vaa;
+                                                                                                                                                                    {
+                                                                                                                                                                        int x = vbo + 1;
+                                                                                                                                                                        int vbp = x + vaa;
+                                                                                                                                                                        {
+                                                                                                                                                                            int x = vbp + 1;
+                                                                                                                                                                            int vbq = x + vaa;
+                                                                                                                                                                            {
+                                                                                                                                                                                int x = vbq + 1;
+                                                                                                                                                                                int vbr = x + vaa;
+                                                                                                                                                                                {
+                                                                                                                                                                                    int x = vbr + 1;
+                                                                                                                                                                                    int vbs = x + vaa;
+                                                                                                                                                                                    {
+                                                                                                                                                                                        int x = vbs + 1;
+                                                                                                                                                                                        int vbt = x + vaa;
+                                                                                                                                                                                        {
+                                                                                                                                                                                            int x = vbt + 1;
+                                                                                                                                                                                            int vbu = x + vaa;
+                                                                                                                                                                                            {
+                                                                                                                                                                                                int x = vbu + 1;
+                                                                                                                                                                                                int vbv = x + vaa;
+                                                                                                                                                                                                {
+                                                                                                                                                                                                    int x = vbv + 1;
+                                                                                                                                                                                                    int vbw = x + vaa;
+                                                                                                                                                                                                    {
+                                                                                                                                                                                                        int x = vbw + 1;
+                                                                                                                                                                                                        int vbx = x + vaa;
+                                                                                                                                                                                                        {
+                                                                                                                                                                                                            int x = vbx + 1;
+                                                                                                                                                                                                            int vby = x + vaa;
+                                                                                                                                                                                                            {
+                                                                                                                                                                                                                int x = vby + 1;
+                                                                                                                                                                                                                int vbz = x + vaa;
+                                                                                                                                                                                                                {
+                                                                                                                                                                                                                    int x = vbz + 1;
+                                                                                                                                                                                                                    int vca = x + vaa;
+                                                                                                                                                                                                                    {
+                                                                                                                                                                                                                        int x = vca + 1;
+                                                                                                                                                                                                                        int vcb = x + vaa;
+                                                                                                                                                                                                                        {
+                                                                                                                                                                                                                            int x = vcb + 1;
+                                                                                                                                                                                                                            int vcc = x + vaa;
+                                                                                                                                                                                                                            {
+                                                                                                                                                                                                                                int x = vcc + 1;
+                                                                                                                                                                                                                                int vcd = x + vaa;
+                                                                                                                                                                                                                                {
+                                                                                                                                                                                                                                    int x = vcd + 1;
+                                                                                                                                                                                                                                    int vce = x + vaa;
+                                                                                                                                                                                                                                    {
+                                                                                                                                                                                                                                        int x = vce + 1;
+                                                                                                                                                                                                                                        int vcf = x + vaa;
+                                                                                                                                                                                                                                        {
+                                                                                                                                                                                                                                            int x = vcf + 1;
+                                                                                                                                                                                                                                            int vcg = x + vaa;
+                                                                                                                                                                                                                                            {
+                                                                                                                                                                                                                                                int x = vcg + 1;
+                                                                                                                                                                                                                                                int vch = x + vaa;
+                                                                                                                                                                                                                                                {
+                                                                                                                                                                                                                                                    int x = vch + 1;
+                                                                                                                                                                                                                                                    int vci = x + vaa;
+                                                                                                                                                                                                                                                    {
+                                                                                                                                                                                                                                                        int x = vci + 1;
+                                                                                                                                                                                                                                                        int vcj = x + vaa;
+                                                                                                                                                                                                                                                        {
+                                                                                                                                                                                                                                                            int x = vcj + 1;
+                                                                                                                                                                                                                                                            int vck = x + vaa;
+                                                                                                                                                                                                                                                            {
+                                                                                                                                                                                                                                                                int x = vck + 1;
+                                                                                                                                                                                                                                                                int vcl = x + vaa;
+                                                                                                                                                                                                                                                                {
+                                                                                                                                                                                                                                                                    int x = vcl + 1;
+                                                                                                                                                                                                                                                                    int vcm = x + vaa;
+                                                                                                                                                                                                                                                                }
+                                                                                                                                                                                                                                                            }
+                                                                                                                                                                                                                                                        }
+                                                                                                                                                                                                                                                    }
+                                                                                                                                                                                                                                                }
+                                                                                                                                                                                                                                            }
+                                                                                                                                                                                                                                        }
+                                                                                                                                                                                                                                    }
+                                                                                                                                                                                                                                }
+                                                                                                                                                                                                                            }
+                                                                                                                                                                                                                        }
+                                                                                                                                                                                                                    }
+                                                                                                                                                                                                                }
+                                                                                                                                                                                                            }
+                                                                                                                                                                                                        }
+                                                                                                                                                                                                    }
+                                                                                                                                                                                                }
+                                                                                                                                                                                            }
+                                                                                                                                                                                        }
+                                                                                                                                                                                    }
+                                                                                                                                                                                }
+                                                                                                                                                                            }
+                                                                                                                                                                        }
+                                                                                                                                                                    }
+                                                                                                                                                                }
+                                                                                                                                                            }
+                                                                                                                                                        }
+                                                                                                                                                    }
+                                                                                                                                                }
+                                                                                                                                            }
+                                                                                                                                        }
+                                                                                                                                    }
+                                                                                                                                }
+                                                                                                                            }
+                                                                                                                        }
+                                                                                                                    }
+                                                                                                                }
+                                                                                                            }
+                                                                                                        }
+                                                                                                    }
+                                                                                                }
+                                                                                            }
+                                                                                        }
+                                                                                    }
+                                                                                }
+                                                                            }
+                                                                        }
+                                                                    }
+                                                                }
+                                                            }
+                                                        }
+                                                    }
+                                                }
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return x + vaa;
+}
+
+int main()
+{
+    return nested(1);
+}
@@ -0,0 +1,24 @@
+// self tail calls ten million deep, which overflow the stack unless -O2 turns them into loops
+int count(int n, int acc)
+{
+    if (n == 0)
+        return acc;
+
+    return count(n - 1, acc + 3);
+}
+
+int gcd(int a, int b)
+{
+    if (b == 0)
+        return a;
+
+    if (a < b)
+        return gcd(b, a);
+
+    return gcd(a - b, b);
+}
+
+int main()
+{
+    return count(10000000, 0) / 1000000 + gcd(1071, 462);
+}